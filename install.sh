@@ -3,3 +3,5 @@
 cp libvlx.so /usr/lib/
 mkdir /usr/include/vlx/
 cp src/vlx.h /usr/include/vlx
+mkdir /usr/share/vlx/
+cp *.spv /usr/share/vlx
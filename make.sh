@@ -1,3 +1,5 @@
 #!/bin/sh
 
 gcc -o libvlx.so src/vlx.c -lvulkan -fPIC -shared
+glslc -o vlx_cull.spv src/shd/cull.comp
+glslc -o vlx_hiz.spv src/shd/hiz.comp
@@ -18,30 +18,131 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <time.h>
+#include "vlx.h"
+
+#define VLX_BLOCK_SIZE 67108864
+#define VLX_BLOCK_UNIT 1024
+#define VLX_REGION_ALIGN 256
+#define VLX_STAGING_SIZE 16777216
+#define VLX_UPLOAD_N 2
+
+#define VLX_BUFFER_READBACK 254
+#define VLX_BUFFER_STAGING 255
+#define VLX_PIPELINE_BUCKETS 64
+#define VLX_STATE_BINDINGS 16
+#define VLX_STATE_PUSH 256
+#define VLX_PROFILE_N 256
+
+struct vlx_block {
+	VkDeviceMemory mem;
+	void* map;
+	uint32_t type;
+	uint8_t lin;
+	VkDeviceSize unit;
+	uint32_t n;
+	uint8_t lg;
+	uint8_t* tree;
+	uint32_t used;
+	struct vlx_block* next;
+};
+
+struct vlx_memory {
+	struct vlx_block* blck;
+	VkDeviceSize off;
+	void* map;
+};
 
 struct vlx_buffer {
 	VkBuffer bfr;
-	VkDeviceMemory mem;
+	struct vlx_memory mem;
 	VkMemoryRequirements req;
+	uint64_t sz;
+	uint32_t rng_n;
+	uint8_t mode;
+	uint8_t init;
 };
 
 struct vlx_image {
 	VkImage img;
 	VkImageView v;
-	VkDeviceMemory mem;
+	struct vlx_memory mem;
 	VkMemoryRequirements req;
 };
 
+struct vlx_copy {
+	VkImage img;
+	VkBufferImageCopy cp;
+	uint8_t pre;
+	uint8_t post;
+	uint8_t copy;
+	VkImageLayout lay;
+	uint32_t gen;
+	uint32_t w;
+	uint32_t h;
+};
+
+struct vlx_upload {
+	struct vlx_buffer stg;
+	uint64_t off;
+	VkBuffer* dst;
+	VkBufferCopy* cp;
+	uint32_t n;
+	uint32_t cap;
+	struct vlx_copy* img;
+	uint32_t img_n;
+	uint32_t img_cap;
+	VkCommandBuffer cmd;
+	VkFence fnc;
+	uint8_t busy;
+	uint64_t id;
+};
+
+struct vlx_transfer {
+	VkQueue que;
+	uint32_t que_i;
+	VkCommandPool pool;
+	struct vlx_upload slot[VLX_UPLOAD_N];
+	uint32_t i;
+	uint64_t sbmt;
+	uint64_t done;
+};
+
 struct vlx_context {
 	VkInstance inst;
+	VkPhysicalDevice gpu;
+	VkPhysicalDeviceProperties prop;
+	VkPhysicalDeviceFeatures feat;
+	VkPhysicalDeviceMemoryProperties mem_prop;
+	struct vlx_block* blck;
 	VkDevice devc;
 	VkQueue que;
 	uint32_t que_i;
-	VkSemaphore smph_img;
-	VkSemaphore smph_drw;
-	VkFence fnc;
+	VkQueue cmp;
+	uint32_t cmp_i;
+	uint32_t frm_n;
+	uint32_t frm_i;
+	struct vlx_transfer upld;
+	struct vlx_transfer txup;
+	VkPipelineCache pipe_cache;
+	char* pipe_path;
+	struct vlx_shader* shdr;
+	struct vlx_pipeline* pipe[VLX_PIPELINE_BUCKETS];
+	uint8_t div;
+	uint8_t wl;
+	uint8_t swap;
+	PFN_vkCmdDrawIndexedIndirectCountKHR draw_cnt;
 	VkFormat img_frmt;
 	VkFormat txtr_frmt;
+	FILE* trce;
+	pthread_mutex_t trce_lock;
+	PFN_vkGetCalibratedTimestampsEXT clbr;
 };
 
 struct vlx_surface {
@@ -55,34 +156,166 @@ struct vlx_surface {
 	VkFramebuffer* frme;
 	uint32_t img_n;
 	uint32_t img_i;
+	uint8_t off;
+	struct vlx_image* off_img;
+	struct vlx_buffer rdbk;
+	uint8_t rdbk_n;
+	uint8_t mode;
+	VkPresentModeKHR pres;
 	struct vlx_image dpth;
 	VkClearValue clr[2];
+	VkSemaphore* smph_img;
+	VkSemaphore* smph_drw;
+	VkSemaphore* smph_cmp;
+	uint8_t cmp;
+	VkSemaphore* smph_gfx;
+	uint8_t* gfx;
+	uint8_t acmp;
+	VkFence* fnc;
+	uint32_t frm_i;
+	struct vlx_profile* prof;
+	struct vlx_query* qry;
+	struct vlx_hiz* hiz;
+};
+
+struct vlx_ring {
+	double smpl[VLX_PROFILE_N];
+	uint32_t i;
+	uint32_t n;
+};
+
+struct vlx_query {
+	struct vlx_surface* srfc;
+	VkQueryPool pool;
+	VkQueryType type;
+	uint32_t n;
+	uint32_t cnt;
+	uint32_t* used;
+	uint64_t* rslt;
+	uint8_t* vld;
+	struct vlx_query* next;
+};
+
+struct vlx_profile {
+	struct vlx_surface* srfc;
+	VkQueryPool pool;
+	uint64_t mask;
+	double prd;
+	uint32_t scp_n;
+	uint32_t scp_cap;
+	char** name;
+	uint8_t* used;
+	struct vlx_ring* ring;
+	uint64_t t_rec;
+	uint64_t* t_sbmt;
+};
+
+struct vlx_state {
+	VkPipeline pipe;
+	VkPipelineLayout layt;
+	uint32_t w;
+	uint32_t h;
+	VkBuffer vrtx[VLX_STATE_BINDINGS];
+	VkDeviceSize vrtx_off[VLX_STATE_BINDINGS];
+	uint32_t vrtx_n;
+	VkBuffer indx;
+	VkDeviceSize indx_off;
+	struct vlx_descriptor* dscr;
+	uint8_t push[VLX_STATE_PUSH];
+	uint64_t push_sz;
+	uint64_t emit;
+	uint64_t skip;
 };
 
 struct vlx_command {
 	VkCommandPool pool;
-	VkCommandBuffer draw;
+	VkCommandBuffer* draw;
+	uint32_t n;
+	uint8_t sec;
+	uint8_t cmp;
+	uint8_t rndr;
+	uint8_t cnts;
+	struct vlx_state state;
+};
+
+struct vlx_shader {
+	VkShaderModule mod;
+	uint64_t hash;
+	uint64_t sz;
+	uint32_t* code;
+	char* path;
+	uint32_t ref;
+	struct vlx_shader* next;
+};
+
+struct vlx_pipeline_key {
+	struct vlx_surface* srfc;
+	uint64_t vert;
+	uint64_t vert_sz;
+	uint64_t frag;
+	uint64_t frag_sz;
+	struct vlx_vertex* vrtx;
+	uint32_t vrtx_gen;
+	struct vlx_descriptor* dscr;
+	uint64_t push_sz;
+	struct vlx_pipeline_state state;
 };
 
 struct vlx_pipeline {
 	VkPipeline pipe;
 	VkPipelineLayout layt;
+	VkPipelineBindPoint bind;
+	VkShaderStageFlags stg;
+	struct vlx_pipeline_key key;
+	uint64_t hash;
+	uint32_t ref;
+	struct vlx_pipeline* next;
 };
 
 struct vlx_vertex {
-	VkBuffer* bfr;
-	VkDeviceMemory* mem;
-	VkMemoryRequirements* req;
+	struct vlx_buffer* bfr;
 	VkPipelineVertexInputStateCreateInfo in;
 	VkVertexInputBindingDescription* bind;
 	uint32_t b;
 	VkVertexInputAttributeDescription* attr;
 	uint32_t a;
+	VkPipelineVertexInputDivisorStateCreateInfoEXT div_in;
+	VkVertexInputBindingDivisorDescriptionEXT* div;
+	uint32_t d;
+	uint32_t gen;
 };
 
 struct vlx_texture {
 	struct vlx_image img;
 	VkSampler smpl;
+	VkImageLayout lay;
+	struct vlx_transfer* xfr;
+	uint64_t id;
+};
+
+struct vlx_format {
+	VkFormat frmt;
+	VkFormat srgb;
+	uint8_t bw;
+	uint8_t bh;
+	uint8_t bs;
+};
+
+#define VLX_FORMAT_X 2
+
+static const struct vlx_format vlx_format[VLX_FORMAT_N + VLX_FORMAT_X] = {
+	{VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_SRGB, 1, 1, 4},
+	{VK_FORMAT_BC1_RGBA_UNORM_BLOCK, VK_FORMAT_BC1_RGBA_SRGB_BLOCK, 4, 4, 8},
+	{VK_FORMAT_BC3_UNORM_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK, 4, 4, 16},
+	{VK_FORMAT_BC4_UNORM_BLOCK, VK_FORMAT_BC4_UNORM_BLOCK, 4, 4, 8},
+	{VK_FORMAT_BC5_UNORM_BLOCK, VK_FORMAT_BC5_UNORM_BLOCK, 4, 4, 16},
+	{VK_FORMAT_BC7_UNORM_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK, 4, 4, 16},
+	{VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK, 4, 4, 16},
+	{VK_FORMAT_ASTC_4x4_UNORM_BLOCK, VK_FORMAT_ASTC_4x4_SRGB_BLOCK, 4, 4, 16},
+	{VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32_SFLOAT, 1, 1, 4},
+	{VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT, 1, 1, 8},
+	{VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGB_SRGB_BLOCK, 4, 4, 8},
+	{VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK, 4, 4, 8}
 };
 
 struct vlx_descriptor {
@@ -90,12 +323,766 @@ struct vlx_descriptor {
 	VkDescriptorSet* set;
 	VkDescriptorSetLayout* layt;
 	uint32_t n;
+	VkDescriptorType* type;
+	uint32_t t;
+	void** bind;
+};
+
+struct vlx_hiz {
+	struct vlx_texture* txtr;
+	VkImageView* mip;
+	uint32_t lvl;
+	uint32_t w;
+	uint32_t h;
+	struct vlx_descriptor* tmpl;
+	struct vlx_descriptor* dscr;
+	struct vlx_pipeline* pipe;
+	uint32_t gen;
+	uint8_t dpth;
+	uint8_t ok;
+	struct vlx_surface* srfc;
+	struct vlx_hiz* next;
+};
+
+struct vlx_cull {
+	struct vlx_buffer obj;
+	struct vlx_buffer drw;
+	struct vlx_buffer cnt;
+	struct vlx_descriptor* tmpl;
+	struct vlx_descriptor* dscr;
+	struct vlx_pipeline* pipe;
+	struct vlx_texture* dmmy;
+	struct vlx_hiz* hiz;
+	uint32_t hiz_gen;
+	uint32_t n;
+	uint32_t act;
+	uint8_t cmpt;
+};
+
+struct vlx_cull_push {
+	float mvp[16];
+	float size[2];
+	uint32_t n;
+	uint32_t cmpt;
+	uint32_t lvl;
 };
 
-struct vlx_context* vlx_context_create(int8_t g) {
+static uint8_t vlx_log2(VkDeviceSize n) {
+	uint8_t lg = 0;
+	while (((VkDeviceSize) 1 << lg) < n) lg++;
+	return lg;
+}
+
+static uint64_t vlx_time(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t vlx_trace_begin(struct vlx_context* cntx) {
+	if (cntx->trce == 0) return 0;
+	return vlx_time();
+}
+
+static void vlx_trace_event(struct vlx_context* cntx, const char* name, uint32_t pid, uint32_t tid, uint64_t t0, uint64_t t1) {
+	pthread_mutex_lock(&(cntx->trce_lock));
+	fprintf(cntx->trce, ",\n{\"name\":\"");
+	for (const char* c = name; *c != 0; c++) {
+		if (*c == '"' || *c == '\\') fputc('\\', cntx->trce);
+		if ((uint8_t) *c >= 0x20) fputc(*c, cntx->trce);
+	}
+	fprintf(cntx->trce, "\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", pid, tid, t0 / 1000.0, (t1 > t0) ? (t1 - t0) / 1000.0 : 0.0);
+	pthread_mutex_unlock(&(cntx->trce_lock));
+}
+
+static void vlx_trace_end(struct vlx_context* cntx, const char* name, uint64_t t0) {
+	if (t0 == 0) return;
+	vlx_trace_event(cntx, name, 0, syscall(SYS_gettid), t0, vlx_time());
+}
+
+static uint32_t vlx_memory_type(struct vlx_context* cntx, uint32_t bits, VkMemoryPropertyFlags need, VkMemoryPropertyFlags want) {
+	for (uint32_t i = 0; i < cntx->mem_prop.memoryTypeCount; i++) {
+		VkMemoryPropertyFlags flag = cntx->mem_prop.memoryTypes[i].propertyFlags;
+		if (((bits >> i) & 1) && (flag & (need | want)) == (need | want)) return i;
+	}
+	for (uint32_t i = 0; i < cntx->mem_prop.memoryTypeCount; i++) {
+		VkMemoryPropertyFlags flag = cntx->mem_prop.memoryTypes[i].propertyFlags;
+		if (((bits >> i) & 1) && (flag & need) == need) return i;
+	}
+	return UINT32_MAX;
+}
+
+static struct vlx_block* vlx_block_create(struct vlx_context* cntx, uint32_t type, uint8_t lin, VkDeviceSize sz, VkDeviceSize unit) {
+	VkMemoryAllocateInfo meminfo;
+		meminfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		meminfo.pNext = 0;
+		meminfo.allocationSize = sz;
+		meminfo.memoryTypeIndex = type;
+	VkDeviceMemory mem;
+	if (vkAllocateMemory(cntx->devc, &meminfo, 0, &mem) != VK_SUCCESS) return 0;
+	
+	struct vlx_block* blck = malloc(sizeof(struct vlx_block));
+	blck->mem = mem;
+	blck->map = 0;
+	if (cntx->mem_prop.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		vkMapMemory(cntx->devc, mem, 0, VK_WHOLE_SIZE, 0, &(blck->map));
+	}
+	blck->type = type;
+	blck->lin = lin;
+	blck->unit = unit;
+	blck->n = sz / unit;
+	blck->lg = vlx_log2(blck->n);
+	blck->tree = malloc(2 * blck->n - 1);
+	blck->used = 0;
+	
+	uint8_t o = blck->lg + 1;
+	for (uint32_t i = 0; i < 2 * blck->n - 1; i++) {
+		if (i != 0 && ((i + 1) & i) == 0) o--;
+		blck->tree[i] = o;
+	}
+	
+	blck->next = cntx->blck;
+	cntx->blck = blck;
+	return blck;
+}
+
+static void vlx_block_destroy(struct vlx_context* cntx, struct vlx_block* blck) {
+	struct vlx_block** link = &(cntx->blck);
+	while (*link != blck) link = &((*link)->next);
+	*link = blck->next;
+	
+	vkFreeMemory(cntx->devc, blck->mem, 0);
+	free(blck->tree);
+	free(blck);
+}
+
+static void vlx_block_update(struct vlx_block* blck, uint32_t i, uint8_t o) {
+	while (i != 0) {
+		i = (i - 1) / 2;
+		o++;
+		uint8_t l = blck->tree[2 * i + 1];
+		uint8_t r = blck->tree[2 * i + 2];
+		if (l == o && r == o) blck->tree[i] = o + 1;
+		else blck->tree[i] = (l > r) ? l : r;
+	}
+}
+
+static int64_t vlx_block_alloc(struct vlx_block* blck, uint8_t k) {
+	if (blck->tree[0] < k + 1) return -1;
+	
+	uint32_t i = 0;
+	uint8_t o = blck->lg;
+	while (o != k) {
+		i = 2 * i + 1;
+		if (blck->tree[i] < k + 1) i++;
+		o--;
+	}
+	blck->tree[i] = 0;
+	vlx_block_update(blck, i, o);
+	blck->used++;
+	
+	return (((int64_t) i + 1) << o) - blck->n;
+}
+
+static void vlx_block_free(struct vlx_block* blck, uint32_t off) {
+	uint32_t i = off + blck->n - 1;
+	uint8_t o = 0;
+	while (blck->tree[i] != 0) {
+		i = (i - 1) / 2;
+		o++;
+	}
+	blck->tree[i] = o + 1;
+	vlx_block_update(blck, i, o);
+	blck->used--;
+}
+
+static int8_t vlx_memory_alloc(struct vlx_context* cntx, VkMemoryRequirements* req, VkMemoryPropertyFlags need, VkMemoryPropertyFlags want, uint8_t lin, struct vlx_memory* mem) {
+	uint32_t type = vlx_memory_type(cntx, req->memoryTypeBits, need, want);
+	if (type == UINT32_MAX) return 0;
+	VkDeviceSize sz = (req->size > req->alignment) ? req->size : req->alignment;
+	
+	struct vlx_block* blck = 0;
+	int64_t off = -1;
+	if (sz <= VLX_BLOCK_SIZE) {
+		uint8_t k = vlx_log2((sz + VLX_BLOCK_UNIT - 1) / VLX_BLOCK_UNIT);
+		for (blck = cntx->blck; blck != 0; blck = blck->next) {
+			if (blck->type != type || blck->lin != lin || blck->unit != VLX_BLOCK_UNIT) continue;
+			off = vlx_block_alloc(blck, k);
+			if (off >= 0) break;
+		}
+		if (blck == 0) {
+			blck = vlx_block_create(cntx, type, lin, VLX_BLOCK_SIZE, VLX_BLOCK_UNIT);
+			if (blck != 0) off = vlx_block_alloc(blck, k);
+		}
+	}
+	if (blck == 0) {
+		blck = vlx_block_create(cntx, type, lin, sz, sz);
+		if (blck == 0) return 0;
+		off = vlx_block_alloc(blck, 0);
+	}
+	
+	mem->blck = blck;
+	mem->off = off * blck->unit;
+	mem->map = 0;
+	if (blck->map != 0) mem->map = (uint8_t*) blck->map + mem->off;
+	return 1;
+}
+
+static void vlx_memory_free(struct vlx_context* cntx, struct vlx_memory* mem) {
+	struct vlx_block* blck = mem->blck;
+	vlx_block_free(blck, mem->off / blck->unit);
+	if (blck->n == 1) vlx_block_destroy(cntx, blck);
+	else if (blck->used == 0) {
+		struct vlx_block* spre = cntx->blck;
+		while (spre != 0 && (spre == blck || spre->used != 0 || spre->type != blck->type || spre->lin != blck->lin || spre->n == 1)) spre = spre->next;
+		if (spre != 0) vlx_block_destroy(cntx, blck);
+	}
+}
+
+static uint32_t vlx_family(struct vlx_context* cntx, uint32_t xfr_i, uint32_t* fam) {
+	uint32_t n = 0;
+	fam[n++] = cntx->que_i;
+	if (cntx->cmp_i != cntx->que_i) fam[n++] = cntx->cmp_i;
+	if (xfr_i != cntx->que_i && xfr_i != cntx->cmp_i) fam[n++] = xfr_i;
+	return n;
+}
+
+static int8_t vlx_buffer_init(struct vlx_context* cntx, struct vlx_buffer* bfr, uint64_t sz, uint8_t mode, VkBufferUsageFlags use) {
+	bfr->sz = sz;
+	bfr->rng_n = 1;
+	bfr->mode = mode;
+	bfr->init = 0;
+	
+	VkMemoryPropertyFlags need = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	VkMemoryPropertyFlags want = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	if (mode == VLX_BUFFER_STREAM || mode == VLX_BUFFER_READBACK) {
+		bfr->rng_n = cntx->frm_n;
+		bfr->sz = (sz + VLX_REGION_ALIGN - 1) & ~((uint64_t) VLX_REGION_ALIGN - 1);
+	}
+	if (mode == VLX_BUFFER_READBACK) {
+		need = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		want = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+	}
+	else if (mode == VLX_BUFFER_STATIC) {
+		use |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		need = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		want = 0;
+	}
+	else if (mode == VLX_BUFFER_STAGING) {
+		want = 0;
+	}
+	
+	uint32_t fam[3];
+	VkBufferCreateInfo bfrinfo;
+		bfrinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bfrinfo.pNext = 0;
+		bfrinfo.flags = 0;
+		bfrinfo.size = bfr->sz * bfr->rng_n;
+		bfrinfo.usage = use;
+		bfrinfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		bfrinfo.queueFamilyIndexCount = vlx_family(cntx, cntx->que_i, fam);
+		bfrinfo.pQueueFamilyIndices = fam;
+	if (bfrinfo.queueFamilyIndexCount > 1) bfrinfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+	vkCreateBuffer(cntx->devc, &bfrinfo, 0, &(bfr->bfr));
+	
+	vkGetBufferMemoryRequirements(cntx->devc, bfr->bfr, &(bfr->req));
+	if (!vlx_memory_alloc(cntx, &(bfr->req), need, want, 1, &(bfr->mem))) {
+		vkDestroyBuffer(cntx->devc, bfr->bfr, 0);
+		return 0;
+	}
+	vkBindBufferMemory(cntx->devc, bfr->bfr, bfr->mem.blck->mem, bfr->mem.off);
+	return 1;
+}
+
+static VkDeviceSize vlx_buffer_region(struct vlx_context* cntx, struct vlx_buffer* bfr) {
+	return (cntx->frm_i % bfr->rng_n) * bfr->sz;
+}
+
+static void vlx_buffer_deinit(struct vlx_context* cntx, struct vlx_buffer* bfr) {
+	vkDestroyBuffer(cntx->devc, bfr->bfr, 0);
+	vlx_memory_free(cntx, &(bfr->mem));
+}
+
+static void vlx_transfer_init(struct vlx_context* cntx, struct vlx_transfer* xfr, VkQueue que, uint32_t que_i) {
+	xfr->que = que;
+	xfr->que_i = que_i;
+	
+	VkCommandPoolCreateInfo poolinfo;
+		poolinfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolinfo.pNext = 0;
+		poolinfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		poolinfo.queueFamilyIndex = que_i;
+	vkCreateCommandPool(cntx->devc, &poolinfo, 0, &(xfr->pool));
+	
+	VkCommandBufferAllocateInfo cmdinfo;
+		cmdinfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		cmdinfo.pNext = 0;
+		cmdinfo.commandPool = xfr->pool;
+		cmdinfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		cmdinfo.commandBufferCount = 1;
+	VkFenceCreateInfo fncinfo;
+		fncinfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fncinfo.pNext = 0;
+		fncinfo.flags = 0;
+	for (uint32_t i = 0; i < VLX_UPLOAD_N; i++) {
+		struct vlx_upload* upld = &(xfr->slot[i]);
+		vlx_buffer_init(cntx, &(upld->stg), VLX_STAGING_SIZE, VLX_BUFFER_STAGING, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+		upld->off = 0;
+		upld->n = 0;
+		upld->cap = 64;
+		upld->dst = malloc(sizeof(VkBuffer) * upld->cap);
+		upld->cp = malloc(sizeof(VkBufferCopy) * upld->cap);
+		upld->img_n = 0;
+		upld->img_cap = 64;
+		upld->img = malloc(sizeof(struct vlx_copy) * upld->img_cap);
+		vkAllocateCommandBuffers(cntx->devc, &cmdinfo, &(upld->cmd));
+		vkCreateFence(cntx->devc, &fncinfo, 0, &(upld->fnc));
+		upld->busy = 0;
+		upld->id = 0;
+	}
+	xfr->i = 0;
+	xfr->sbmt = 0;
+	xfr->done = 0;
+}
+
+static struct vlx_upload* vlx_transfer_slot(struct vlx_context* cntx, struct vlx_transfer* xfr) {
+	struct vlx_upload* upld = &(xfr->slot[xfr->i]);
+	if (upld->busy) {
+		vkWaitForFences(cntx->devc, 1, &(upld->fnc), 1, UINT64_MAX);
+		vkResetFences(cntx->devc, 1, &(upld->fnc));
+		if (upld->id > xfr->done) xfr->done = upld->id;
+		upld->busy = 0;
+		upld->off = 0;
+		upld->n = 0;
+		upld->img_n = 0;
+	}
+	return upld;
+}
+
+static uint8_t vlx_transfer_overlap(struct vlx_upload* upld, uint32_t b, uint32_t j) {
+	for (uint32_t k = b; k < j; k++) {
+		if (upld->dst[k] != upld->dst[j]) continue;
+		if (upld->cp[j].dstOffset < upld->cp[k].dstOffset + upld->cp[k].size && upld->cp[k].dstOffset < upld->cp[j].dstOffset + upld->cp[j].size) return 1;
+	}
+	return 0;
+}
+
+static void vlx_transfer_flush(struct vlx_context* cntx, struct vlx_transfer* xfr) {
+	struct vlx_upload* upld = &(xfr->slot[xfr->i]);
+	if (upld->busy || (upld->n == 0 && upld->img_n == 0)) return;
+	uint64_t trce = vlx_trace_begin(cntx);
+	
+	VkCommandBufferBeginInfo cbfrinfo;
+		cbfrinfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		cbfrinfo.pNext = 0;
+		cbfrinfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		cbfrinfo.pInheritanceInfo = 0;
+	vkBeginCommandBuffer(upld->cmd, &cbfrinfo);
+	
+	VkPipelineStageFlags stg = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	if (upld->n != 0) vkCmdPipelineBarrier(upld->cmd, stg, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, 0, 0, 0, 0, 0);
+	
+	VkImageMemoryBarrier imgmembar;
+		imgmembar.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imgmembar.pNext = 0;
+		imgmembar.srcAccessMask = 0;
+		imgmembar.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		imgmembar.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imgmembar.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		imgmembar.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imgmembar.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imgmembar.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		imgmembar.subresourceRange.baseMipLevel = 0;
+		imgmembar.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+		imgmembar.subresourceRange.baseArrayLayer = 0;
+		imgmembar.subresourceRange.layerCount = 1;
+	for (uint32_t i = 0; i < upld->img_n; i++) {
+		if (!upld->img[i].pre) continue;
+		imgmembar.image = upld->img[i].img;
+		vkCmdPipelineBarrier(upld->cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, 0, 0, 0, 1, &imgmembar);
+	}
+	
+	VkMemoryBarrier membar;
+		membar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		membar.pNext = 0;
+		membar.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		membar.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	uint32_t b = 0;
+	for (uint32_t i = 0; i < upld->n;) {
+		uint32_t j = i + 1;
+		while (j < upld->n && upld->dst[j] == upld->dst[i] && !vlx_transfer_overlap(upld, b, j)) j++;
+		vkCmdCopyBuffer(upld->cmd, upld->stg.bfr, upld->dst[i], j - i, &(upld->cp[i]));
+		if (j < upld->n && vlx_transfer_overlap(upld, b, j)) {
+			vkCmdPipelineBarrier(upld->cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &membar, 0, 0, 0, 0);
+			b = j;
+		}
+		i = j;
+	}
+	
+	for (uint32_t i = 0; i < upld->img_n; i++) {
+		if (!upld->img[i].copy) continue;
+		vkCmdCopyBufferToImage(upld->cmd, upld->stg.bfr, upld->img[i].img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &(upld->img[i].cp));
+	}
+	
+	if (upld->n != 0) {
+			membar.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(upld->cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, stg, 0, 1, &membar, 0, 0, 0, 0);
+	}
+	
+	VkImageBlit blit;
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.srcOffsets[0].x = 0;
+		blit.srcOffsets[0].y = 0;
+		blit.srcOffsets[0].z = 0;
+		blit.srcOffsets[1].z = 1;
+		blit.dstSubresource = blit.srcSubresource;
+		blit.dstOffsets[0] = blit.srcOffsets[0];
+		blit.dstOffsets[1].z = 1;
+	for (uint32_t i = 0; i < upld->img_n; i++) {
+		struct vlx_copy* cp = &(upld->img[i]);
+		if (!cp->post) continue;
+		imgmembar.image = cp->img;
+		int32_t w = cp->w;
+		int32_t h = cp->h;
+		for (uint32_t j = 1; j < cp->gen; j++) {
+				imgmembar.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				imgmembar.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+				imgmembar.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+				imgmembar.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+				imgmembar.subresourceRange.baseMipLevel = j - 1;
+				imgmembar.subresourceRange.levelCount = 1;
+			vkCmdPipelineBarrier(upld->cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, 0, 0, 0, 1, &imgmembar);
+			
+				blit.srcSubresource.mipLevel = j - 1;
+				blit.srcOffsets[1].x = w;
+				blit.srcOffsets[1].y = h;
+				blit.dstSubresource.mipLevel = j;
+				blit.dstOffsets[1].x = (w > 1) ? w / 2 : 1;
+				blit.dstOffsets[1].y = (h > 1) ? h / 2 : 1;
+			vkCmdBlitImage(upld->cmd, cp->img, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, cp->img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+			
+				imgmembar.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+				imgmembar.dstAccessMask = 0;
+				imgmembar.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+				imgmembar.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			vkCmdPipelineBarrier(upld->cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, 0, 0, 0, 1, &imgmembar);
+			
+			w = blit.dstOffsets[1].x;
+			h = blit.dstOffsets[1].y;
+		}
+			imgmembar.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			imgmembar.dstAccessMask = 0;
+			imgmembar.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			imgmembar.newLayout = cp->lay;
+			imgmembar.subresourceRange.baseMipLevel = (cp->gen > 1) ? cp->gen - 1 : 0;
+			imgmembar.subresourceRange.levelCount = (cp->gen > 1) ? 1 : VK_REMAINING_MIP_LEVELS;
+		vkCmdPipelineBarrier(upld->cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, 0, 0, 0, 1, &imgmembar);
+	}
+	
+	vkEndCommandBuffer(upld->cmd);
+	
+	VkSubmitInfo sbmtinfo;
+		sbmtinfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		sbmtinfo.pNext = 0;
+		sbmtinfo.waitSemaphoreCount = 0;
+		sbmtinfo.pWaitSemaphores = 0;
+		sbmtinfo.pWaitDstStageMask = 0;
+		sbmtinfo.commandBufferCount = 1;
+		sbmtinfo.pCommandBuffers = &(upld->cmd);
+		sbmtinfo.signalSemaphoreCount = 0;
+		sbmtinfo.pSignalSemaphores = 0;
+	vkQueueSubmit(xfr->que, 1, &sbmtinfo, upld->fnc);
+	
+	xfr->sbmt++;
+	upld->id = xfr->sbmt;
+	upld->busy = 1;
+	xfr->i = (xfr->i + 1) % VLX_UPLOAD_N;
+	vlx_trace_end(cntx, "vlx_upload_flush", trce);
+}
+
+static void vlx_transfer_poll(struct vlx_context* cntx, struct vlx_transfer* xfr) {
+	for (uint32_t i = 0; i < VLX_UPLOAD_N; i++) {
+		struct vlx_upload* upld = &(xfr->slot[i]);
+		if (upld->busy && upld->id > xfr->done && vkGetFenceStatus(cntx->devc, upld->fnc) == VK_SUCCESS) xfr->done = upld->id;
+	}
+}
+
+static void vlx_transfer_wait(struct vlx_context* cntx, struct vlx_transfer* xfr, uint64_t id) {
+	if (id > xfr->sbmt) vlx_transfer_flush(cntx, xfr);
+	for (uint32_t i = 0; i < VLX_UPLOAD_N; i++) {
+		struct vlx_upload* upld = &(xfr->slot[i]);
+		if (upld->busy && upld->id == id) {
+			uint64_t trce = vlx_trace_begin(cntx);
+			vkWaitForFences(cntx->devc, 1, &(upld->fnc), 1, UINT64_MAX);
+			vlx_trace_end(cntx, "upload fence wait", trce);
+			if (id > xfr->done) xfr->done = id;
+		}
+	}
+}
+
+static void vlx_upload_buffer(struct vlx_context* cntx, struct vlx_transfer* xfr, struct vlx_buffer* bfr, void* data, uint64_t sz, uint64_t off) {
+	while (sz > 0) {
+		struct vlx_upload* upld = vlx_transfer_slot(cntx, xfr);
+		if (upld->off == VLX_STAGING_SIZE) {
+			vlx_transfer_flush(cntx, xfr);
+			continue;
+		}
+		
+		uint64_t cp_sz = VLX_STAGING_SIZE - upld->off;
+		if (cp_sz > sz) cp_sz = sz;
+		memcpy((uint8_t*) upld->stg.mem.map + upld->off, data, cp_sz);
+		
+		if (upld->n == upld->cap) {
+			upld->cap *= 2;
+			upld->dst = realloc(upld->dst, sizeof(VkBuffer) * upld->cap);
+			upld->cp = realloc(upld->cp, sizeof(VkBufferCopy) * upld->cap);
+		}
+		upld->dst[upld->n] = bfr->bfr;
+		upld->cp[upld->n].srcOffset = upld->off;
+		upld->cp[upld->n].dstOffset = off;
+		upld->cp[upld->n].size = cp_sz;
+		upld->n++;
+		
+		upld->off = (upld->off + cp_sz + 15) & ~((uint64_t) 15);
+		data = (uint8_t*) data + cp_sz;
+		sz -= cp_sz;
+		off += cp_sz;
+	}
+}
+
+static void vlx_upload_image(struct vlx_context* cntx, struct vlx_transfer* xfr, VkImage img, uint8_t* data, uint32_t w, uint32_t h, uint32_t mip, uint32_t bpr, uint32_t rpb, uint8_t pre, uint8_t post, uint32_t gen) {
+	uint32_t rows = (h + rpb - 1) / rpb;
+	uint32_t row = 0;
+	while (row < rows) {
+		struct vlx_upload* upld = vlx_transfer_slot(cntx, xfr);
+		uint32_t n = (VLX_STAGING_SIZE - upld->off) / bpr;
+		if (n == 0) {
+			vlx_transfer_flush(cntx, xfr);
+			continue;
+		}
+		if (n > rows - row) n = rows - row;
+		memcpy((uint8_t*) upld->stg.mem.map + upld->off, data + (uint64_t) row * bpr, (uint64_t) n * bpr);
+		
+		if (upld->img_n == upld->img_cap) {
+			upld->img_cap *= 2;
+			upld->img = realloc(upld->img, sizeof(struct vlx_copy) * upld->img_cap);
+		}
+		struct vlx_copy* cp = &(upld->img[upld->img_n]);
+		cp->img = img;
+		cp->cp.bufferOffset = upld->off;
+		cp->cp.bufferRowLength = 0;
+		cp->cp.bufferImageHeight = 0;
+		cp->cp.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		cp->cp.imageSubresource.mipLevel = mip;
+		cp->cp.imageSubresource.baseArrayLayer = 0;
+		cp->cp.imageSubresource.layerCount = 1;
+		cp->cp.imageOffset.x = 0;
+		cp->cp.imageOffset.y = row * rpb;
+		cp->cp.imageOffset.z = 0;
+		cp->cp.imageExtent.width = w;
+		cp->cp.imageExtent.height = n * rpb;
+		if (cp->cp.imageOffset.y + cp->cp.imageExtent.height > h) cp->cp.imageExtent.height = h - cp->cp.imageOffset.y;
+		cp->cp.imageExtent.depth = 1;
+		cp->pre = pre && row == 0;
+		cp->post = post && row + n == rows;
+		cp->copy = 1;
+		cp->lay = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		cp->gen = gen;
+		cp->w = w;
+		cp->h = h;
+		upld->img_n++;
+		
+		upld->off = (upld->off + (uint64_t) n * bpr + 15) & ~((uint64_t) 15);
+		row += n;
+	}
+}
+
+static void vlx_upload_layout(struct vlx_context* cntx, struct vlx_transfer* xfr, VkImage img, VkImageLayout lay) {
+	struct vlx_upload* upld = vlx_transfer_slot(cntx, xfr);
+	if (upld->img_n == upld->img_cap) {
+		upld->img_cap *= 2;
+		upld->img = realloc(upld->img, sizeof(struct vlx_copy) * upld->img_cap);
+	}
+	struct vlx_copy* cp = &(upld->img[upld->img_n]);
+	cp->img = img;
+	cp->pre = 1;
+	cp->post = 1;
+	cp->copy = 0;
+	cp->lay = lay;
+	cp->gen = 0;
+	cp->w = 0;
+	cp->h = 0;
+	upld->img_n++;
+}
+
+static void vlx_transfer_destroy(struct vlx_context* cntx, struct vlx_transfer* xfr) {
+	for (uint32_t i = 0; i < VLX_UPLOAD_N; i++) {
+		struct vlx_upload* upld = &(xfr->slot[i]);
+		if (upld->busy) vkWaitForFences(cntx->devc, 1, &(upld->fnc), 1, UINT64_MAX);
+		vkDestroyFence(cntx->devc, upld->fnc, 0);
+		vkFreeCommandBuffers(cntx->devc, xfr->pool, 1, &(upld->cmd));
+		vlx_buffer_deinit(cntx, &(upld->stg));
+		free(upld->dst);
+		free(upld->cp);
+		free(upld->img);
+	}
+	vkDestroyCommandPool(cntx->devc, xfr->pool, 0);
+}
+
+static int8_t vlx_extension(VkExtensionProperties* ext, uint32_t n, const char* name) {
+	for (uint32_t i = 0; i < n; i++) {
+		if (strcmp(ext[i].extensionName, name) == 0) return 1;
+	}
+	return 0;
+}
+
+static int64_t vlx_device_score(VkPhysicalDevice gpu) {
+	VkPhysicalDeviceProperties prop;
+	vkGetPhysicalDeviceProperties(gpu, &prop);
+	
+	uint32_t quen;
+	vkGetPhysicalDeviceQueueFamilyProperties(gpu, &quen, 0);
+	VkQueueFamilyProperties* queprop = malloc(sizeof(VkQueueFamilyProperties) * quen);
+	vkGetPhysicalDeviceQueueFamilyProperties(gpu, &quen, queprop);
+	int8_t gfx = 0;
+	for (uint32_t i = 0; i < quen; i++) {
+		if (queprop[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) gfx = 1;
+	}
+	free(queprop);
+	
+	uint32_t extn;
+	vkEnumerateDeviceExtensionProperties(gpu, 0, &extn, 0);
+	VkExtensionProperties* ext = malloc(sizeof(VkExtensionProperties) * extn);
+	vkEnumerateDeviceExtensionProperties(gpu, 0, &extn, ext);
+	int8_t swap = vlx_extension(ext, extn, VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	free(ext);
+	
+	if (!gfx) return -1;
+	
+	int64_t score = 0;
+	if (prop.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) score = 4;
+	else if (prop.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU) score = 3;
+	else if (prop.deviceType == VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU) score = 2;
+	else if (prop.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU) score = 1;
+	
+	VkPhysicalDeviceMemoryProperties mem_prop;
+	vkGetPhysicalDeviceMemoryProperties(gpu, &mem_prop);
+	uint64_t lcl = 0;
+	for (uint32_t i = 0; i < mem_prop.memoryHeapCount; i++) {
+		if ((mem_prop.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) && mem_prop.memoryHeaps[i].size > lcl) lcl = mem_prop.memoryHeaps[i].size;
+	}
+	if (swap) score += 8;
+	return (score << 40) + (lcl >> 20);
+}
+
+static uint32_t vlx_device_select(VkPhysicalDevice* gpu, uint32_t gpun, const char* dev) {
+	const char* env = getenv("VLX_DEVICE");
+	if (env != 0 && env[0] != 0) dev = env;
+	
+	int32_t type = -1;
+	int32_t indx = -1;
+	if (dev != 0) {
+		if (strcmp(dev, "discrete") == 0) type = VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+		else if (strcmp(dev, "integrated") == 0) type = VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU;
+		else if (strcmp(dev, "virtual") == 0) type = VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU;
+		else if (strcmp(dev, "cpu") == 0) type = VK_PHYSICAL_DEVICE_TYPE_CPU;
+		else if (dev[0] >= '0' && dev[0] <= '9' && strspn(dev, "0123456789") == strlen(dev)) indx = atoi(dev);
+	}
+	
+	uint32_t best = 0;
+	int64_t best_score = -1;
+	uint32_t pick = 0;
+	int64_t pick_score = -1;
+	for (uint32_t i = 0; i < gpun; i++) {
+		int64_t score = vlx_device_score(gpu[i]);
+		if (score < 0) continue;
+		if (score > best_score) {
+			best = i;
+			best_score = score;
+		}
+		if (dev == 0) continue;
+		
+		VkPhysicalDeviceProperties prop;
+		vkGetPhysicalDeviceProperties(gpu[i], &prop);
+		int8_t match = 0;
+		if (type >= 0) match = prop.deviceType == type;
+		else if (indx >= 0) match = indx == i;
+		else match = strstr(prop.deviceName, dev) != 0;
+		if (match && score > pick_score) {
+			pick = i;
+			pick_score = score;
+		}
+	}
+	return (pick_score >= 0) ? pick : best;
+}
+
+static void vlx_pipeline_cache_init(struct vlx_context* cntx, const char* path) {
+	cntx->pipe_path = 0;
+	uint64_t sz = 0;
+	uint8_t* data = 0;
+	if (path != 0) {
+		cntx->pipe_path = malloc(strlen(path) + 1);
+		strcpy(cntx->pipe_path, path);
+		
+		FILE* f = fopen(path, "rb");
+		if (f != 0) {
+			fseek(f, 0, SEEK_END);
+			sz = ftell(f);
+			fseek(f, 0, SEEK_SET);
+			data = malloc(sz);
+			if (fread(data, sz, 1, f) != 1) sz = 0;
+			fclose(f);
+		}
+	}
+	
+	if (sz < 16 + VK_UUID_SIZE) sz = 0;
+	else {
+		uint32_t* hdr = (uint32_t*) data;
+		if (hdr[0] < 16 + VK_UUID_SIZE || hdr[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || hdr[2] != cntx->prop.vendorID || hdr[3] != cntx->prop.deviceID) sz = 0;
+		if (memcmp(data + 16, cntx->prop.pipelineCacheUUID, VK_UUID_SIZE) != 0) sz = 0;
+	}
+	
+	VkPipelineCacheCreateInfo cacheinfo;
+		cacheinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cacheinfo.pNext = 0;
+		cacheinfo.flags = 0;
+		cacheinfo.initialDataSize = sz;
+		cacheinfo.pInitialData = data;
+	vkCreatePipelineCache(cntx->devc, &cacheinfo, 0, &(cntx->pipe_cache));
+	free(data);
+}
+
+struct vlx_context* vlx_context_create(int8_t g, uint8_t frm_n, const char* pipe_path, const char* dev) {
 	struct vlx_context* cntx = malloc(sizeof(struct vlx_context));
+	cntx->trce = 0;
+	cntx->clbr = 0;
+	const char* trce_path = getenv("VLX_TRACE");
+	if (trce_path != 0 && trce_path[0] != 0) cntx->trce = fopen(trce_path, "w");
+	if (cntx->trce != 0) {
+		pthread_mutex_init(&(cntx->trce_lock), 0);
+		fprintf(cntx->trce, "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"vlx cpu\"}},\n");
+		fprintf(cntx->trce, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"vlx gpu\"}}");
+	}
+	uint64_t trce = vlx_trace_begin(cntx);
+	
+	uint32_t extn;
+	vkEnumerateInstanceExtensionProperties(0, &extn, 0);
+	VkExtensionProperties* ext = malloc(sizeof(VkExtensionProperties) * extn);
+	vkEnumerateInstanceExtensionProperties(0, &extn, ext);
+	
+	const char* instext[3] = {0, 0, 0};
+	uint32_t instextn = 0;
+	cntx->wl = vlx_extension(ext, extn, VK_KHR_SURFACE_EXTENSION_NAME) && vlx_extension(ext, extn, VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME);
+	if (cntx->wl) {
+		instext[instextn++] = VK_KHR_SURFACE_EXTENSION_NAME;
+		instext[instextn++] = VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME;
+	}
+	int8_t prop2 = vlx_extension(ext, extn, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+	if (prop2) instext[instextn++] = VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME;
+	free(ext);
 	
-	const char* instext[] = {VK_KHR_SURFACE_EXTENSION_NAME, VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME};
 	VkInstanceCreateInfo instinfo;
 		instinfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 		instinfo.pNext = 0;
@@ -103,7 +1090,7 @@ struct vlx_context* vlx_context_create(int8_t g) {
 		instinfo.pApplicationInfo = 0;
 		instinfo.enabledLayerCount = 0;
 		instinfo.ppEnabledLayerNames = 0;
-		instinfo.enabledExtensionCount = 2;
+		instinfo.enabledExtensionCount = instextn;
 		instinfo.ppEnabledExtensionNames = instext;
 	vkCreateInstance(&instinfo, 0, &(cntx->inst));
 
@@ -111,51 +1098,152 @@ struct vlx_context* vlx_context_create(int8_t g) {
 	vkEnumeratePhysicalDevices(cntx->inst, &gpun, 0);
 	VkPhysicalDevice* gpu = malloc(sizeof(VkPhysicalDevice) * gpun);
 	vkEnumeratePhysicalDevices(cntx->inst, &gpun, gpu);
+	cntx->gpu = gpu[vlx_device_select(gpu, gpun, dev)];
+	free(gpu);
 	
-	VkPhysicalDeviceProperties gpuprop;
-	vkGetPhysicalDeviceProperties(gpu[0], &gpuprop);
+	vkGetPhysicalDeviceProperties(cntx->gpu, &(cntx->prop));
+	VkPhysicalDeviceFeatures devfeat;
+	vkGetPhysicalDeviceFeatures(cntx->gpu, &devfeat);
 	VkPhysicalDeviceFeatures gpufeat;
-	vkGetPhysicalDeviceFeatures(gpu[0], &gpufeat);
+	memset(&gpufeat, 0, sizeof(VkPhysicalDeviceFeatures));
+		gpufeat.fillModeNonSolid = devfeat.fillModeNonSolid;
+		gpufeat.samplerAnisotropy = devfeat.samplerAnisotropy;
+		gpufeat.multiDrawIndirect = devfeat.multiDrawIndirect;
+		gpufeat.drawIndirectFirstInstance = devfeat.drawIndirectFirstInstance;
+		gpufeat.textureCompressionBC = devfeat.textureCompressionBC;
+		gpufeat.textureCompressionETC2 = devfeat.textureCompressionETC2;
+		gpufeat.textureCompressionASTC_LDR = devfeat.textureCompressionASTC_LDR;
+		gpufeat.occlusionQueryPrecise = devfeat.occlusionQueryPrecise;
+		gpufeat.pipelineStatisticsQuery = devfeat.pipelineStatisticsQuery;
+	cntx->feat = gpufeat;
+	
+	vkGetPhysicalDeviceMemoryProperties(cntx->gpu, &(cntx->mem_prop));
+	cntx->blck = 0;
+	
+	uint32_t quen;
+	vkGetPhysicalDeviceQueueFamilyProperties(cntx->gpu, &quen, 0);
+	VkQueueFamilyProperties* queprop = malloc(sizeof(VkQueueFamilyProperties) * quen);
+	vkGetPhysicalDeviceQueueFamilyProperties(cntx->gpu, &quen, queprop);
 	
 	cntx->que_i = 0;
-	float prio = 0.f;
-	VkDeviceQueueCreateInfo queinfo;
-		queinfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-		queinfo.pNext = 0;
-		queinfo.flags = 0;
-		queinfo.queueFamilyIndex = cntx->que_i;
-		queinfo.queueCount = 1;
-		queinfo.pQueuePriorities = &prio;
-	
-	const char* devext = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+	for (uint32_t i = 0; i < quen; i++) {
+		if (queprop[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+			cntx->que_i = i;
+			break;
+		}
+	}
+	cntx->cmp_i = cntx->que_i;
+	for (uint32_t i = 0; i < quen; i++) {
+		if ((queprop[i].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queprop[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+			cntx->cmp_i = i;
+			break;
+		}
+	}
+	uint32_t cmp_q = (cntx->cmp_i == cntx->que_i && queprop[cntx->que_i].queueCount > 1) ? 1 : 0;
+	uint32_t xfr_i = cntx->que_i;
+	for (uint32_t i = 0; i < quen; i++) {
+		if ((queprop[i].queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queprop[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) && queprop[i].minImageTransferGranularity.width == 1 && queprop[i].minImageTransferGranularity.height == 1) {
+			xfr_i = i;
+			break;
+		}
+	}
+	free(queprop);
+	
+	float prio[2] = {1.f, 1.f};
+	VkDeviceQueueCreateInfo queinfo[3];
+	uint32_t queinfon = 1;
+		queinfo[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		queinfo[0].pNext = 0;
+		queinfo[0].flags = 0;
+		queinfo[0].queueFamilyIndex = cntx->que_i;
+		queinfo[0].queueCount = cmp_q + 1;
+		queinfo[0].pQueuePriorities = prio;
+	if (cntx->cmp_i != cntx->que_i) {
+		queinfo[queinfon] = queinfo[0];
+		queinfo[queinfon].queueFamilyIndex = cntx->cmp_i;
+		queinfo[queinfon].queueCount = 1;
+		queinfon++;
+	}
+	if (xfr_i != cntx->que_i) {
+		queinfo[queinfon] = queinfo[0];
+		queinfo[queinfon].queueFamilyIndex = xfr_i;
+		queinfo[queinfon].queueCount = 1;
+		queinfon++;
+	}
+	
+	vkEnumerateDeviceExtensionProperties(cntx->gpu, 0, &extn, 0);
+	ext = malloc(sizeof(VkExtensionProperties) * extn);
+	vkEnumerateDeviceExtensionProperties(cntx->gpu, 0, &extn, ext);
+	
+	const char* devext[4] = {0, 0, 0, 0};
+	uint32_t devextn = 0;
+	cntx->swap = cntx->wl && vlx_extension(ext, extn, VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	if (cntx->swap) devext[devextn++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+	int8_t drawcnt = vlx_extension(ext, extn, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+	if (drawcnt) devext[devextn++] = VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME;
+	int8_t clbr = 0;
+	if (cntx->trce != 0 && vlx_extension(ext, extn, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME)) {
+		PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT getdom = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT) vkGetInstanceProcAddr(cntx->inst, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+		uint32_t domn = 0;
+		if (getdom != 0) getdom(cntx->gpu, &domn, 0);
+		VkTimeDomainEXT* dom = malloc(sizeof(VkTimeDomainEXT) * (domn + 1));
+		if (getdom != 0) getdom(cntx->gpu, &domn, dom);
+		uint8_t found = 0;
+		for (uint32_t i = 0; i < domn; i++) {
+			if (dom[i] == VK_TIME_DOMAIN_DEVICE_EXT) found |= 1;
+			if (dom[i] == VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT) found |= 2;
+		}
+		free(dom);
+		if (found == 3) {
+			devext[devextn++] = VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME;
+			clbr = 1;
+		}
+	}
+	VkPhysicalDeviceVertexAttributeDivisorFeaturesEXT divfeat;
+		divfeat.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VERTEX_ATTRIBUTE_DIVISOR_FEATURES_EXT;
+		divfeat.pNext = 0;
+		divfeat.vertexAttributeInstanceRateDivisor = 0;
+		divfeat.vertexAttributeInstanceRateZeroDivisor = 0;
+	cntx->div = 0;
+	PFN_vkGetPhysicalDeviceFeatures2KHR getfeat2 = 0;
+	if (prop2) getfeat2 = (PFN_vkGetPhysicalDeviceFeatures2KHR) vkGetInstanceProcAddr(cntx->inst, "vkGetPhysicalDeviceFeatures2KHR");
+	if (getfeat2 != 0 && vlx_extension(ext, extn, VK_EXT_VERTEX_ATTRIBUTE_DIVISOR_EXTENSION_NAME)) {
+		VkPhysicalDeviceFeatures2 gpufeat2;
+			gpufeat2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			gpufeat2.pNext = &divfeat;
+		getfeat2(cntx->gpu, &gpufeat2);
+		if (divfeat.vertexAttributeInstanceRateDivisor) {
+			devext[devextn++] = VK_EXT_VERTEX_ATTRIBUTE_DIVISOR_EXTENSION_NAME;
+			cntx->div = 1;
+		}
+			divfeat.vertexAttributeInstanceRateZeroDivisor = 0;
+	}
+	free(ext);
+	
 	VkDeviceCreateInfo devcinfo;
 		devcinfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-		devcinfo.pNext = 0;
+		devcinfo.pNext = cntx->div ? &divfeat : 0;
 		devcinfo.flags = 0;
-		devcinfo.queueCreateInfoCount = 1;
-		devcinfo.pQueueCreateInfos = &queinfo;
+		devcinfo.queueCreateInfoCount = queinfon;
+		devcinfo.pQueueCreateInfos = queinfo;
 		devcinfo.enabledLayerCount = 0;
 		devcinfo.ppEnabledLayerNames = 0;
-		devcinfo.enabledExtensionCount = 1;
-		devcinfo.ppEnabledExtensionNames = &devext;
+		devcinfo.enabledExtensionCount = devextn;
+		devcinfo.ppEnabledExtensionNames = devext;
 		devcinfo.pEnabledFeatures = &gpufeat;
-	vkCreateDevice(gpu[0], &devcinfo, 0, &(cntx->devc));
-	vkGetDeviceQueue(cntx->devc, 0, 0, &(cntx->que));
+	vkCreateDevice(cntx->gpu, &devcinfo, 0, &(cntx->devc));
+	vkGetDeviceQueue(cntx->devc, cntx->que_i, 0, &(cntx->que));
+	vkGetDeviceQueue(cntx->devc, cntx->cmp_i, cmp_q, &(cntx->cmp));
+	VkQueue xfr;
+	vkGetDeviceQueue(cntx->devc, xfr_i, 0, &xfr);
 	
-	free(gpu);
+	if (clbr) cntx->clbr = (PFN_vkGetCalibratedTimestampsEXT) vkGetDeviceProcAddr(cntx->devc, "vkGetCalibratedTimestampsEXT");
+	cntx->draw_cnt = 0;
+	if (drawcnt) cntx->draw_cnt = (PFN_vkCmdDrawIndexedIndirectCountKHR) vkGetDeviceProcAddr(cntx->devc, "vkCmdDrawIndexedIndirectCountKHR");
 	
-	VkSemaphoreCreateInfo smphinfo;
-		smphinfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-		smphinfo.pNext = 0;
-		smphinfo.flags = 0;
-	vkCreateSemaphore(cntx->devc, &smphinfo, 0, &(cntx->smph_img));
-	vkCreateSemaphore(cntx->devc, &smphinfo, 0, &(cntx->smph_drw));
-	
-	VkFenceCreateInfo fncinfo;
-		fncinfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fncinfo.pNext = 0;
-		fncinfo.flags = 0;
-	vkCreateFence(cntx->devc, &fncinfo, 0, &(cntx->fnc));
+	cntx->frm_n = frm_n;
+	if (frm_n == 0) cntx->frm_n = 1;
+	cntx->frm_i = 0;
 	
 	cntx->img_frmt = VK_FORMAT_B8G8R8A8_UNORM;
 	cntx->txtr_frmt = VK_FORMAT_R8G8B8A8_UNORM;
@@ -164,11 +1252,110 @@ struct vlx_context* vlx_context_create(int8_t g) {
 		cntx->txtr_frmt = VK_FORMAT_R8G8B8A8_SRGB;
 	}
 	
+	vlx_transfer_init(cntx, &(cntx->upld), cntx->que, cntx->que_i);
+	vlx_transfer_init(cntx, &(cntx->txup), xfr, xfr_i);
+	vlx_pipeline_cache_init(cntx, pipe_path);
+	cntx->shdr = 0;
+	memset(cntx->pipe, 0, sizeof(cntx->pipe));
+	
+	vlx_trace_end(cntx, "vlx_context_create", trce);
 	return cntx;
 }
 
-struct vlx_surface* vlx_surface_create(struct vlx_context* cntx, struct wl_display* disp, struct wl_surface* wrfc, uint16_t w, uint16_t h) {
+void vlx_context_report(struct vlx_context* cntx, struct vlx_device_report* rprt) {
+	memset(rprt, 0, sizeof(struct vlx_device_report));
+	memcpy(rprt->name, cntx->prop.deviceName, sizeof(rprt->name));
+	rprt->name[sizeof(rprt->name) - 1] = 0;
+	rprt->type = cntx->prop.deviceType;
+	rprt->vndr = cntx->prop.vendorID;
+	rprt->id = cntx->prop.deviceID;
+	rprt->api = cntx->prop.apiVersion;
+	rprt->drvr = cntx->prop.driverVersion;
+	
+	rprt->heap_n = cntx->mem_prop.memoryHeapCount;
+	if (rprt->heap_n > VLX_REPORT_N) rprt->heap_n = VLX_REPORT_N;
+	for (uint32_t i = 0; i < rprt->heap_n; i++) {
+		rprt->heap_sz[i] = cntx->mem_prop.memoryHeaps[i].size;
+		rprt->heap_lcl[i] = (cntx->mem_prop.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+	}
+	
+	uint32_t quen;
+	vkGetPhysicalDeviceQueueFamilyProperties(cntx->gpu, &quen, 0);
+	VkQueueFamilyProperties* queprop = malloc(sizeof(VkQueueFamilyProperties) * quen);
+	vkGetPhysicalDeviceQueueFamilyProperties(cntx->gpu, &quen, queprop);
+	rprt->fam_n = (quen > VLX_REPORT_N) ? VLX_REPORT_N : quen;
+	for (uint32_t i = 0; i < rprt->fam_n; i++) {
+		rprt->fam_flag[i] = queprop[i].queueFlags;
+		rprt->fam_que[i] = queprop[i].queueCount;
+	}
+	free(queprop);
+	rprt->que_i = cntx->que_i;
+	rprt->cmp_i = cntx->cmp_i;
+	rprt->xfr_i = cntx->txup.que_i;
+	
+	rprt->img_max = cntx->prop.limits.maxImageDimension2D;
+	rprt->push_max = cntx->prop.limits.maxPushConstantsSize;
+	rprt->ubo_max = cntx->prop.limits.maxUniformBufferRange;
+	rprt->ssbo_max = cntx->prop.limits.maxStorageBufferRange;
+	rprt->draw_max = cntx->feat.multiDrawIndirect ? cntx->prop.limits.maxDrawIndirectCount : 1;
+	rprt->wg_max = cntx->prop.limits.maxComputeWorkGroupInvocations;
+	rprt->smpl = cntx->prop.limits.framebufferColorSampleCounts & cntx->prop.limits.framebufferDepthSampleCounts;
+	rprt->aniso = cntx->feat.samplerAnisotropy ? cntx->prop.limits.maxSamplerAnisotropy : 1.f;
+	rprt->ts = cntx->prop.limits.timestampPeriod;
+	
+	rprt->non_solid = cntx->feat.fillModeNonSolid;
+	rprt->draw_cnt = cntx->draw_cnt != 0;
+	rprt->div = cntx->div;
+	
+	for (uint32_t i = 0; i < VLX_FORMAT_N; i++) {
+		VkFormatProperties frmtprop;
+		vkGetPhysicalDeviceFormatProperties(cntx->gpu, vlx_format[i].frmt, &frmtprop);
+		VkFormatFeatureFlags feat = frmtprop.optimalTilingFeatures;
+		if (feat & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) rprt->frmt[i] |= VLX_SUPPORT_SAMPLED;
+		if (feat & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) rprt->frmt[i] |= VLX_SUPPORT_FILTER;
+		if (feat & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) rprt->frmt[i] |= VLX_SUPPORT_STORAGE;
+		if (feat & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT) rprt->frmt[i] |= VLX_SUPPORT_COLOR;
+	}
+}
+
+static struct vlx_surface* vlx_surface_init(struct vlx_context* cntx, uint16_t w, uint16_t h) {
 	struct vlx_surface* srfc = calloc(1, sizeof(struct vlx_surface));
+	srfc->pres = VK_PRESENT_MODE_FIFO_KHR;
+	srfc->w = w;
+	srfc->h = h;
+	
+	srfc->smph_img = malloc(sizeof(VkSemaphore) * cntx->frm_n);
+	srfc->smph_drw = malloc(sizeof(VkSemaphore) * cntx->frm_n);
+	srfc->smph_cmp = malloc(sizeof(VkSemaphore) * cntx->frm_n);
+	srfc->cmp = 0;
+	srfc->smph_gfx = malloc(sizeof(VkSemaphore) * cntx->frm_n);
+	srfc->gfx = calloc(cntx->frm_n, 1);
+	srfc->acmp = 0;
+	srfc->fnc = malloc(sizeof(VkFence) * cntx->frm_n);
+	srfc->frm_i = 0;
+	
+	VkSemaphoreCreateInfo smphinfo;
+		smphinfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		smphinfo.pNext = 0;
+		smphinfo.flags = 0;
+	VkFenceCreateInfo fncinfo;
+		fncinfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fncinfo.pNext = 0;
+		fncinfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+	for (uint32_t i = 0; i < cntx->frm_n; i++) {
+		vkCreateSemaphore(cntx->devc, &smphinfo, 0, &(srfc->smph_img[i]));
+		vkCreateSemaphore(cntx->devc, &smphinfo, 0, &(srfc->smph_drw[i]));
+		vkCreateSemaphore(cntx->devc, &smphinfo, 0, &(srfc->smph_cmp[i]));
+		vkCreateSemaphore(cntx->devc, &smphinfo, 0, &(srfc->smph_gfx[i]));
+		vkCreateFence(cntx->devc, &fncinfo, 0, &(srfc->fnc[i]));
+	}
+	
+	return srfc;
+}
+
+struct vlx_surface* vlx_surface_create(struct vlx_context* cntx, void* disp, void* wrfc, uint16_t w, uint16_t h) {
+	if (!cntx->swap) return 0;
+	struct vlx_surface* srfc = vlx_surface_init(cntx, w, h);
 	
 	VkWaylandSurfaceCreateInfoKHR wayinfo;
 		wayinfo.sType = VK_STRUCTURE_TYPE_WAYLAND_SURFACE_CREATE_INFO_KHR;
@@ -178,33 +1365,55 @@ struct vlx_surface* vlx_surface_create(struct vlx_context* cntx, struct wl_displ
 		wayinfo.surface = wrfc;
 	vkCreateWaylandSurfaceKHR(cntx->inst, &wayinfo, 0, &(srfc->srfc));
 	
-	srfc->w = w;
-	srfc->h = h;
-	
 	return srfc;
 }
 
-struct vlx_command* vlx_command_create(struct vlx_context* cntx) {
+struct vlx_surface* vlx_surface_create_offscreen(struct vlx_context* cntx, uint16_t w, uint16_t h) {
+	struct vlx_surface* srfc = vlx_surface_init(cntx, w, h);
+	srfc->off = 1;
+	return srfc;
+}
+
+static struct vlx_command* vlx_command_init(struct vlx_context* cntx, uint8_t sec, uint8_t cmp) {
 	struct vlx_command* cmd = malloc(sizeof(struct vlx_command));
+	cmd->draw = malloc(sizeof(VkCommandBuffer) * cntx->frm_n);
+	cmd->n = cntx->frm_n;
+	cmd->sec = sec;
+	cmd->cmp = cmp;
+	cmd->rndr = 0;
+	cmd->cnts = 0;
+	memset(&(cmd->state), 0, sizeof(struct vlx_state));
 	
 	VkCommandPoolCreateInfo poolinfo;
 		poolinfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 		poolinfo.pNext = 0;
 		poolinfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-		poolinfo.queueFamilyIndex = cntx->que_i;
+		poolinfo.queueFamilyIndex = cmp ? cntx->cmp_i : cntx->que_i;
 	vkCreateCommandPool(cntx->devc, &poolinfo, 0, &(cmd->pool));
 	
 	VkCommandBufferAllocateInfo cmdinfo;
 		cmdinfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		cmdinfo.pNext = 0;
 		cmdinfo.commandPool = cmd->pool;
-		cmdinfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		cmdinfo.commandBufferCount = 1;
-	vkAllocateCommandBuffers(cntx->devc, &cmdinfo, &(cmd->draw));
+		cmdinfo.level = sec ? VK_COMMAND_BUFFER_LEVEL_SECONDARY : VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		cmdinfo.commandBufferCount = cmd->n;
+	vkAllocateCommandBuffers(cntx->devc, &cmdinfo, cmd->draw);
 	
 	return cmd;
 }
 
+struct vlx_command* vlx_command_create(struct vlx_context* cntx) {
+	return vlx_command_init(cntx, 0, 0);
+}
+
+struct vlx_command* vlx_command_create_secondary(struct vlx_context* cntx) {
+	return vlx_command_init(cntx, 1, 0);
+}
+
+struct vlx_command* vlx_command_create_compute(struct vlx_context* cntx) {
+	return vlx_command_init(cntx, 0, 1);
+}
+
 void vlx_surface_init_render_pass(struct vlx_context* cntx, struct vlx_surface* srfc) {
 	VkAttachmentDescription atch[2];
 		atch[0].flags = 0;
@@ -215,7 +1424,7 @@ void vlx_surface_init_render_pass(struct vlx_context* cntx, struct vlx_surface*
 		atch[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		atch[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		atch[0].initialLayout = 0;
-		atch[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		atch[0].finalLayout = srfc->off ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 		atch[1].flags = 0;
 		atch[1].format = VK_FORMAT_D32_SFLOAT;
 		atch[1].samples = VK_SAMPLE_COUNT_1_BIT;
@@ -242,6 +1451,14 @@ void vlx_surface_init_render_pass(struct vlx_context* cntx, struct vlx_surface*
 		subdesc.pDepthStencilAttachment = &depref;
 		subdesc.preserveAttachmentCount = 0;
 		subdesc.pPreserveAttachments = 0;
+	VkSubpassDependency dep;
+		dep.srcSubpass = VK_SUBPASS_EXTERNAL;
+		dep.dstSubpass = 0;
+		dep.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dep.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dep.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dep.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dep.dependencyFlags = 0;
 	VkRenderPassCreateInfo rndrinfo;
 		rndrinfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
 		rndrinfo.pNext = 0;
@@ -250,19 +1467,159 @@ void vlx_surface_init_render_pass(struct vlx_context* cntx, struct vlx_surface*
 		rndrinfo.pAttachments = atch;
 		rndrinfo.subpassCount = 1;
 		rndrinfo.pSubpasses = &subdesc;
-		rndrinfo.dependencyCount = 0;
-		rndrinfo.pDependencies = 0;
+		rndrinfo.dependencyCount = 1;
+		rndrinfo.pDependencies = &dep;
 	vkCreateRenderPass(cntx->devc, &rndrinfo, 0, &(srfc->rndr));
 }
 
-void vlx_surface_init_swapchain(struct vlx_context* cntx, struct vlx_surface* srfc) {
+static VkPresentModeKHR vlx_present_mode(struct vlx_context* cntx, struct vlx_surface* srfc) {
+	uint32_t presn;
+	vkGetPhysicalDeviceSurfacePresentModesKHR(cntx->gpu, srfc->srfc, &presn, 0);
+	VkPresentModeKHR* pres = malloc(sizeof(VkPresentModeKHR) * presn);
+	vkGetPhysicalDeviceSurfacePresentModesKHR(cntx->gpu, srfc->srfc, &presn, pres);
+	
+	VkPresentModeKHR pref[4] = {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR};
+	if (srfc->mode == VLX_PRESENT_MAILBOX) {
+		pref[0] = VK_PRESENT_MODE_MAILBOX_KHR;
+		pref[1] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+		pref[2] = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+	}
+	else if (srfc->mode == VLX_PRESENT_IMMEDIATE) {
+		pref[0] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+		pref[1] = VK_PRESENT_MODE_MAILBOX_KHR;
+		pref[2] = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+	}
+	else if (srfc->mode == VLX_PRESENT_RELAXED) pref[0] = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+	
+	VkPresentModeKHR mode = VK_PRESENT_MODE_FIFO_KHR;
+	for (uint32_t i = 0; i < 4 && mode == VK_PRESENT_MODE_FIFO_KHR; i++) {
+		for (uint32_t j = 0; j < presn; j++) {
+			if (pres[j] == pref[i]) {
+				mode = pref[i];
+				break;
+			}
+		}
+	}
+	free(pres);
+	return mode;
+}
+
+static void vlx_surface_fail_offscreen(struct vlx_context* cntx, struct vlx_surface* srfc) {
+	for (uint32_t i = 0; i < srfc->img_n; i++) {
+		vkDestroyImageView(cntx->devc, srfc->off_img[i].v, 0);
+		vkDestroyImage(cntx->devc, srfc->off_img[i].img, 0);
+		vlx_memory_free(cntx, &(srfc->off_img[i].mem));
+	}
+	free(srfc->off_img);
+	free(srfc->swap_img);
+	free(srfc->swap_img_v);
+	srfc->off_img = 0;
+	srfc->swap_img = 0;
+	srfc->swap_img_v = 0;
+	srfc->img_n = 0;
+	srfc->rdbk_n = 0;
+}
+
+static int8_t vlx_surface_init_offscreen(struct vlx_context* cntx, struct vlx_surface* srfc) {
+	srfc->img_n = cntx->frm_n;
+	srfc->off_img = malloc(sizeof(struct vlx_image) * srfc->img_n);
+	srfc->swap_img = malloc(sizeof(VkImage) * srfc->img_n);
+	srfc->swap_img_v = malloc(sizeof(VkImageView) * srfc->img_n);
+	
+	VkImageCreateInfo imginfo;
+		imginfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imginfo.pNext = 0;
+		imginfo.flags = 0;
+		imginfo.imageType = VK_IMAGE_TYPE_2D;
+		imginfo.format = cntx->img_frmt;
+		imginfo.extent.width = srfc->w;
+		imginfo.extent.height = srfc->h;
+		imginfo.extent.depth = 1;
+		imginfo.mipLevels = 1;
+		imginfo.arrayLayers = 1;
+		imginfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imginfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imginfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		imginfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imginfo.queueFamilyIndexCount = 1;
+		imginfo.pQueueFamilyIndices = &(cntx->que_i);
+		imginfo.initialLayout = 0;
+	VkImageViewCreateInfo imgvinfo;
+		imgvinfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		imgvinfo.pNext = 0;
+		imgvinfo.flags = 0;
+		imgvinfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		imgvinfo.format = cntx->img_frmt;
+		imgvinfo.components.r = 0;
+		imgvinfo.components.g = 0;
+		imgvinfo.components.b = 0;
+		imgvinfo.components.a = 0;
+		imgvinfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		imgvinfo.subresourceRange.baseMipLevel = 0;
+		imgvinfo.subresourceRange.levelCount = 1;
+		imgvinfo.subresourceRange.baseArrayLayer = 0;
+		imgvinfo.subresourceRange.layerCount = 1;
+	for (uint32_t i = 0; i < srfc->img_n; i++) {
+		struct vlx_image* img = &(srfc->off_img[i]);
+		vkCreateImage(cntx->devc, &imginfo, 0, &(img->img));
+		vkGetImageMemoryRequirements(cntx->devc, img->img, &(img->req));
+		if (!vlx_memory_alloc(cntx, &(img->req), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, 0, &(img->mem))) {
+			vkDestroyImage(cntx->devc, img->img, 0);
+			srfc->img_n = i;
+			vlx_surface_fail_offscreen(cntx, srfc);
+			return 0;
+		}
+		vkBindImageMemory(cntx->devc, img->img, img->mem.blck->mem, img->mem.off);
+		imgvinfo.image = img->img;
+		vkCreateImageView(cntx->devc, &imgvinfo, 0, &(img->v));
+		srfc->swap_img[i] = img->img;
+		srfc->swap_img_v[i] = img->v;
+	}
+	
+	if (!vlx_buffer_init(cntx, &(srfc->rdbk), (uint64_t) srfc->w * srfc->h * 4, VLX_BUFFER_READBACK, VK_BUFFER_USAGE_TRANSFER_DST_BIT)) {
+		vlx_surface_fail_offscreen(cntx, srfc);
+		return 0;
+	}
+	srfc->rdbk_n = 0;
+	return 1;
+}
+
+static void vlx_surface_release_offscreen(struct vlx_context* cntx, struct vlx_surface* srfc) {
+	if (srfc->img_n == 0) return;
+	for (uint32_t i = 0; i < srfc->img_n; i++) {
+		vkDestroyImage(cntx->devc, srfc->off_img[i].img, 0);
+		vlx_memory_free(cntx, &(srfc->off_img[i].mem));
+	}
+	free(srfc->off_img);
+	vlx_buffer_deinit(cntx, &(srfc->rdbk));
+}
+
+int8_t vlx_surface_init_swapchain(struct vlx_context* cntx, struct vlx_surface* srfc) {
+	if (srfc->off) return vlx_surface_init_offscreen(cntx, srfc);
 	VkSwapchainKHR swap_anc = srfc->swap;
+	srfc->pres = vlx_present_mode(cntx, srfc);
+	
+	VkSurfaceCapabilitiesKHR srfccap;
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(cntx->gpu, srfc->srfc, &srfccap);
+	uint32_t img_n = cntx->frm_n + 1;
+	if (srfc->pres == VK_PRESENT_MODE_MAILBOX_KHR && img_n < 3) img_n = 3;
+	if (img_n < srfccap.minImageCount) img_n = srfccap.minImageCount;
+	if (srfccap.maxImageCount != 0 && img_n > srfccap.maxImageCount) img_n = srfccap.maxImageCount;
+	if (srfccap.currentExtent.width != UINT32_MAX) {
+		srfc->w = srfccap.currentExtent.width;
+		srfc->h = srfccap.currentExtent.height;
+	}
+	if (srfc->w < srfccap.minImageExtent.width) srfc->w = srfccap.minImageExtent.width;
+	if (srfc->w > srfccap.maxImageExtent.width) srfc->w = srfccap.maxImageExtent.width;
+	if (srfc->h < srfccap.minImageExtent.height) srfc->h = srfccap.minImageExtent.height;
+	if (srfc->h > srfccap.maxImageExtent.height) srfc->h = srfccap.maxImageExtent.height;
+	
 	VkSwapchainCreateInfoKHR swapinfo;
 		swapinfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
 		swapinfo.pNext = 0;
 		swapinfo.flags = 0;
 		swapinfo.surface = srfc->srfc;
-		swapinfo.minImageCount = 3;
+		swapinfo.minImageCount = img_n;
 		swapinfo.imageFormat = cntx->img_frmt;
 		swapinfo.imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
 		swapinfo.imageExtent.width = srfc->w;
@@ -274,7 +1631,7 @@ void vlx_surface_init_swapchain(struct vlx_context* cntx, struct vlx_surface* sr
 		swapinfo.pQueueFamilyIndices = &(cntx->que_i);
 		swapinfo.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
 		swapinfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-		swapinfo.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+		swapinfo.presentMode = srfc->pres;
 		swapinfo.clipped = 1;
 		swapinfo.oldSwapchain = swap_anc;
 	vkCreateSwapchainKHR(cntx->devc, &swapinfo, 0, &(srfc->swap));
@@ -307,9 +1664,10 @@ void vlx_surface_init_swapchain(struct vlx_context* cntx, struct vlx_surface* sr
 		imgvinfo.image = srfc->swap_img[i];
 		vkCreateImageView(cntx->devc, &imgvinfo, 0, &(srfc->swap_img_v)[i]);
 	}
+	return 1;
 }
 
-void vlx_surface_init_depth_buffer(struct vlx_context* cntx, struct vlx_surface* srfc) {
+int8_t vlx_surface_init_depth_buffer(struct vlx_context* cntx, struct vlx_surface* srfc) {
 	VkImageCreateInfo imginfo;
 		imginfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 		imginfo.pNext = 0;
@@ -322,7 +1680,7 @@ void vlx_surface_init_depth_buffer(struct vlx_context* cntx, struct vlx_surface*
 		imginfo.arrayLayers = 1;
 		imginfo.samples = VK_SAMPLE_COUNT_1_BIT;
 		imginfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-		imginfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		imginfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 		imginfo.sharingMode = 0;
 		imginfo.queueFamilyIndexCount = 1;
 		imginfo.pQueueFamilyIndices = &(cntx->que_i);
@@ -330,13 +1688,14 @@ void vlx_surface_init_depth_buffer(struct vlx_context* cntx, struct vlx_surface*
 	vkCreateImage(cntx->devc, &imginfo, 0, &(srfc->dpth.img));
 	
 	vkGetImageMemoryRequirements(cntx->devc, srfc->dpth.img, &(srfc->dpth.req));
-	VkMemoryAllocateInfo meminfo;
-		meminfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		meminfo.pNext = 0;
-		meminfo.allocationSize = srfc->dpth.req.size;
-		meminfo.memoryTypeIndex = 0;
-	vkAllocateMemory(cntx->devc, &meminfo, 0, &(srfc->dpth.mem));
-	vkBindImageMemory(cntx->devc, srfc->dpth.img, srfc->dpth.mem, 0);
+	if (!vlx_memory_alloc(cntx, &(srfc->dpth.req), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, 0, &(srfc->dpth.mem))) {
+		vkDestroyImage(cntx->devc, srfc->dpth.img, 0);
+		srfc->dpth.img = 0;
+		srfc->dpth.v = 0;
+		srfc->dpth.mem.blck = 0;
+		return 0;
+	}
+	vkBindImageMemory(cntx->devc, srfc->dpth.img, srfc->dpth.mem.blck->mem, srfc->dpth.mem.off);
 	
 	VkImageViewCreateInfo imgvinfo;
 		imgvinfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -351,56 +1710,130 @@ void vlx_surface_init_depth_buffer(struct vlx_context* cntx, struct vlx_surface*
 		imgvinfo.subresourceRange.baseArrayLayer = 0;
 		imgvinfo.subresourceRange.layerCount = 1;
 	vkCreateImageView(cntx->devc, &imgvinfo, 0, &(srfc->dpth.v));
+	return 1;
 }
 
-struct vlx_pipeline* vlx_pipeline_create(struct vlx_context* cntx, struct vlx_surface* srfc, int8_t* pthv, int8_t* pthf, struct vlx_vertex* vrtx, struct vlx_descriptor* dscr, uint64_t push_sz) {
-	struct vlx_pipeline* pipe = malloc(sizeof(struct vlx_pipeline));
-	
-	FILE* f = fopen(pthv, "rb");
-	fseek(f, 0, SEEK_END);
-	uint64_t sz = ftell(f);
-	fseek(f, 0, SEEK_SET);
-	uint32_t* src = malloc(sz);
-	fread(src, sz, 1, f);
-	fclose(f);
+static void vlx_surface_release_depth_buffer(struct vlx_context* cntx, struct vlx_surface* srfc) {
+	if (srfc->dpth.mem.blck == 0) return;
+	vkDestroyImageView(cntx->devc, srfc->dpth.v, 0);
+	vkDestroyImage(cntx->devc, srfc->dpth.img, 0);
+	vlx_memory_free(cntx, &(srfc->dpth.mem));
+	srfc->dpth.img = 0;
+	srfc->dpth.v = 0;
+	srfc->dpth.mem.blck = 0;
+}
+
+static struct vlx_shader* vlx_shader_find(struct vlx_context* cntx, const char* path, const uint32_t* code, uint64_t hash, uint64_t sz) {
+	for (struct vlx_shader* shdr = cntx->shdr; shdr != 0; shdr = shdr->next) {
+		if ((path != 0 && shdr->path != 0 && strcmp(shdr->path, path) == 0) || (path == 0 && shdr->hash == hash && shdr->sz == sz && memcmp(shdr->code, code, sz) == 0)) {
+			shdr->ref++;
+			return shdr;
+		}
+	}
+	return 0;
+}
+
+static struct vlx_shader* vlx_shader_init(struct vlx_context* cntx, const uint32_t* code, uint64_t sz, const char* path) {
+	uint64_t hash = 14695981039346656037ULL;
+	for (uint64_t i = 0; i < sz; i++) {
+		hash = (hash ^ ((uint8_t*) code)[i]) * 1099511628211ULL;
+	}
+	struct vlx_shader* shdr = vlx_shader_find(cntx, 0, code, hash, sz);
+	if (shdr != 0) return shdr;
+	
+	shdr = malloc(sizeof(struct vlx_shader));
+	shdr->hash = hash;
+	shdr->sz = sz;
+	shdr->code = malloc(sz);
+	memcpy(shdr->code, code, sz);
+	shdr->path = 0;
+	if (path != 0) {
+		shdr->path = malloc(strlen(path) + 1);
+		strcpy(shdr->path, path);
+	}
+	shdr->ref = 1;
+	uint64_t trce = vlx_trace_begin(cntx);
 	
-	VkShaderModule shdv;
 	VkShaderModuleCreateInfo shdinfo;
 		shdinfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
 		shdinfo.pNext = 0;
 		shdinfo.flags = 0;
 		shdinfo.codeSize = sz;
-		shdinfo.pCode = src;
-	vkCreateShaderModule(cntx->devc, &shdinfo, 0, &shdv);
-	free(src);
-	
-	f = fopen(pthf, "rb");
-	fseek(f, 0, SEEK_END);
-	sz = ftell(f);
-	fseek(f, 0, SEEK_SET);
-	src = malloc(sz);
-	fread(src, sz, 1, f);
-	fclose(f);
-	
-	VkShaderModule shdf;
-		shdinfo.codeSize = sz;
-		shdinfo.pCode = src;
-	vkCreateShaderModule(cntx->devc, &shdinfo, 0, &shdf);
-	free(src);
+		shdinfo.pCode = code;
+	vkCreateShaderModule(cntx->devc, &shdinfo, 0, &(shdr->mod));
+	vlx_trace_end(cntx, "vlx_shader_create", trce);
+	
+	shdr->next = cntx->shdr;
+	cntx->shdr = shdr;
+	return shdr;
+}
+
+struct vlx_shader* vlx_shader_create(struct vlx_context* cntx, const uint32_t* code, uint64_t sz) {
+	return vlx_shader_init(cntx, code, sz, 0);
+}
+
+struct vlx_shader* vlx_shader_load(struct vlx_context* cntx, const char* path) {
+	struct vlx_shader* shdr = vlx_shader_find(cntx, path, 0, 0, 0);
+	if (shdr != 0) return shdr;
+	
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return 0;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < 4 || st.st_size % 4 != 0) {
+		close(fd);
+		return 0;
+	}
+	uint64_t sz = st.st_size;
+	void* map = mmap(0, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return 0;
+	
+	shdr = vlx_shader_init(cntx, map, sz, path);
+	munmap(map, sz);
+	
+	return shdr;
+}
+
+static void vlx_pipeline_layout(struct vlx_context* cntx, struct vlx_pipeline* pipe, struct vlx_descriptor* dscr, uint64_t push_sz) {
+	VkPushConstantRange pushrng;
+		pushrng.stageFlags = pipe->stg;
+		pushrng.offset = 0;
+		pushrng.size = push_sz;
+	
+	VkPipelineLayoutCreateInfo pipelaytinfo;
+		pipelaytinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelaytinfo.pNext = 0;
+		pipelaytinfo.flags = 0;
+		pipelaytinfo.setLayoutCount = 0;
+		pipelaytinfo.pSetLayouts = 0;
+	if (dscr != 0) {
+		pipelaytinfo.setLayoutCount = dscr->n;
+		pipelaytinfo.pSetLayouts = dscr->layt;
+	}
+		pipelaytinfo.pushConstantRangeCount = (push_sz != 0) ? 1 : 0;
+		pipelaytinfo.pPushConstantRanges = &pushrng;
+	vkCreatePipelineLayout(cntx->devc, &pipelaytinfo, 0, &(pipe->layt));
+}
+
+static struct vlx_pipeline* vlx_pipeline_build(struct vlx_context* cntx, const struct vlx_pipeline_info* info) {
+	uint64_t trce = vlx_trace_begin(cntx);
+	struct vlx_pipeline* pipe = malloc(sizeof(struct vlx_pipeline));
+	pipe->bind = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	pipe->stg = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 	
 	VkPipelineShaderStageCreateInfo stginfo[2];
 		stginfo[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		stginfo[0].pNext = 0;
 		stginfo[0].flags = 0;
 		stginfo[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-		stginfo[0].module = shdv;
+		stginfo[0].module = info->vert->mod;
 		stginfo[0].pName = "main";
 		stginfo[0].pSpecializationInfo = 0;
 		stginfo[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		stginfo[1].pNext = 0;
 		stginfo[1].flags = 0;
 		stginfo[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		stginfo[1].module = shdf;
+		stginfo[1].module = info->frag->mod;
 		stginfo[1].pName = "main";
 		stginfo[1].pSpecializationInfo = 0;
 	
@@ -410,6 +1843,16 @@ struct vlx_pipeline* vlx_pipeline_create(struct vlx_context* cntx, struct vlx_su
 		inasminfo.flags = 0;
 		inasminfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
 		inasminfo.primitiveRestartEnable = 1;
+	if (info->state.topo != VLX_TOPOLOGY_TRIANGLE_STRIP) {
+			inasminfo.primitiveRestartEnable = 0;
+		if (info->state.topo == VLX_TOPOLOGY_TRIANGLE_LIST) inasminfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		if (info->state.topo == VLX_TOPOLOGY_LINE_LIST) inasminfo.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+		if (info->state.topo == VLX_TOPOLOGY_LINE_STRIP) {
+				inasminfo.topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+				inasminfo.primitiveRestartEnable = 1;
+		}
+		if (info->state.topo == VLX_TOPOLOGY_POINT_LIST) inasminfo.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+	}
 		
 	VkViewport vprt;
 		vprt.x = 0.f;
@@ -448,6 +1891,13 @@ struct vlx_pipeline* vlx_pipeline_create(struct vlx_context* cntx, struct vlx_su
 		rstrinfo.depthBiasClamp = 0.f;
 		rstrinfo.depthBiasSlopeFactor = 0.f;
 		rstrinfo.lineWidth = 1.f;
+	if (cntx->feat.fillModeNonSolid) {
+		if (info->state.poly == VLX_POLYGON_LINE) rstrinfo.polygonMode = VK_POLYGON_MODE_LINE;
+		if (info->state.poly == VLX_POLYGON_POINT) rstrinfo.polygonMode = VK_POLYGON_MODE_POINT;
+	}
+	if (info->state.cull == VLX_CULL_BACK) rstrinfo.cullMode = VK_CULL_MODE_BACK_BIT;
+	if (info->state.cull == VLX_CULL_FRONT) rstrinfo.cullMode = VK_CULL_MODE_FRONT_BIT;
+	if (info->state.front == VLX_FRONT_CCW) rstrinfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
 		
 	VkPipelineMultisampleStateCreateInfo multinfo;
 		multinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
@@ -485,6 +1935,16 @@ struct vlx_pipeline* vlx_pipeline_create(struct vlx_context* cntx, struct vlx_su
 		dpthinfo.back.reference = 0;
 		dpthinfo.minDepthBounds = 0.f;
 		dpthinfo.maxDepthBounds = 1.f;
+	if (info->state.dpth == VLX_DEPTH_TEST) dpthinfo.depthWriteEnable = 0;
+	if (info->state.dpth == VLX_DEPTH_OFF) {
+			dpthinfo.depthTestEnable = 0;
+			dpthinfo.depthWriteEnable = 0;
+	}
+	if (info->state.cmp == VLX_COMPARE_LESS) dpthinfo.depthCompareOp = VK_COMPARE_OP_LESS;
+	if (info->state.cmp == VLX_COMPARE_GREATER) dpthinfo.depthCompareOp = VK_COMPARE_OP_GREATER;
+	if (info->state.cmp == VLX_COMPARE_GREATER_OR_EQUAL) dpthinfo.depthCompareOp = VK_COMPARE_OP_GREATER_OR_EQUAL;
+	if (info->state.cmp == VLX_COMPARE_EQUAL) dpthinfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+	if (info->state.cmp == VLX_COMPARE_ALWAYS) dpthinfo.depthCompareOp = VK_COMPARE_OP_ALWAYS;
 		
 	VkPipelineColorBlendAttachmentState colblndatch;
 		colblndatch.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -495,6 +1955,16 @@ struct vlx_pipeline* vlx_pipeline_create(struct vlx_context* cntx, struct vlx_su
 		colblndatch.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
 		colblndatch.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
 		colblndatch.alphaBlendOp = VK_BLEND_OP_ADD;
+	if (info->state.blend == VLX_BLEND_NONE) colblndatch.blendEnable = 0;
+	if (info->state.blend == VLX_BLEND_ADD) {
+			colblndatch.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+			colblndatch.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+			colblndatch.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	}
+	if (info->state.blend == VLX_BLEND_PREMULTIPLIED) {
+			colblndatch.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+			colblndatch.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	}
 		
 	VkPipelineColorBlendStateCreateInfo colblndinfo;
 		colblndinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
@@ -517,24 +1987,10 @@ struct vlx_pipeline* vlx_pipeline_create(struct vlx_context* cntx, struct vlx_su
 		dyninfo.dynamicStateCount = 2;
 		dyninfo.pDynamicStates = dyn;
 		
-	VkPushConstantRange pushrng;
-		pushrng.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		pushrng.offset = 0;
-		pushrng.size = push_sz;
+	vlx_pipeline_layout(cntx, pipe, info->dscr, info->push_sz);
 	
-	VkPipelineLayoutCreateInfo pipelaytinfo;
-		pipelaytinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelaytinfo.pNext = 0;
-		pipelaytinfo.flags = 0;
-		pipelaytinfo.setLayoutCount = 0;
-		pipelaytinfo.pSetLayouts = 0;
-	if (dscr != 0) {
-		pipelaytinfo.setLayoutCount = dscr->n;
-		pipelaytinfo.pSetLayouts = dscr->layt;
-	}
-		pipelaytinfo.pushConstantRangeCount = 1;
-		pipelaytinfo.pPushConstantRanges = &pushrng;
-	vkCreatePipelineLayout(cntx->devc, &pipelaytinfo, 0, &(pipe->layt));
+	VkPipelineVertexInputStateCreateInfo vrtxinfo = info->vrtx->in;
+	if (cntx->div && info->vrtx->d > 0) vrtxinfo.pNext = &(info->vrtx->div_in);
 	
 	VkGraphicsPipelineCreateInfo pipeinfo;
 		pipeinfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -542,7 +1998,7 @@ struct vlx_pipeline* vlx_pipeline_create(struct vlx_context* cntx, struct vlx_su
 		pipeinfo.flags = 0;
 		pipeinfo.stageCount = 2;
 		pipeinfo.pStages = stginfo;
-		pipeinfo.pVertexInputState = &(vrtx->in);
+		pipeinfo.pVertexInputState = &vrtxinfo;
 		pipeinfo.pInputAssemblyState = &inasminfo;
 		pipeinfo.pTessellationState = 0;
 		pipeinfo.pViewportState = &vprtinfo;
@@ -552,18 +2008,231 @@ struct vlx_pipeline* vlx_pipeline_create(struct vlx_context* cntx, struct vlx_su
 		pipeinfo.pColorBlendState = &colblndinfo;
 		pipeinfo.pDynamicState = &dyninfo;
 		pipeinfo.layout = pipe->layt;
-		pipeinfo.renderPass = srfc->rndr;
+		pipeinfo.renderPass = info->srfc->rndr;
 		pipeinfo.subpass = 0;
 		pipeinfo.basePipelineHandle = 0;
 		pipeinfo.basePipelineIndex = 0;
-	vkCreateGraphicsPipelines(cntx->devc, 0, 1, &pipeinfo, 0, &(pipe->pipe));
+	vkCreateGraphicsPipelines(cntx->devc, cntx->pipe_cache, 1, &pipeinfo, 0, &(pipe->pipe));
+	vlx_trace_end(cntx, "vlx_pipeline_create", trce);
 	
-	vkDestroyShaderModule(cntx->devc, shdv, 0);
-	vkDestroyShaderModule(cntx->devc, shdf, 0);
+	return pipe;
+}
+
+static uint64_t vlx_pipeline_hash(const struct vlx_pipeline_key* key) {
+	uint64_t hash = 14695981039346656037ULL;
+	for (uint64_t i = 0; i < sizeof(struct vlx_pipeline_key); i++) {
+		hash = (hash ^ ((uint8_t*) key)[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+static uint64_t vlx_pipeline_key(const struct vlx_pipeline_info* info, struct vlx_pipeline_key* key) {
+	memset(key, 0, sizeof(struct vlx_pipeline_key));
+	key->srfc = info->srfc;
+	key->vert = info->vert->hash;
+	key->vert_sz = info->vert->sz;
+	key->frag = info->frag->hash;
+	key->frag_sz = info->frag->sz;
+	key->vrtx = info->vrtx;
+	key->vrtx_gen = (info->vrtx != 0) ? info->vrtx->gen : 0;
+	key->dscr = info->dscr;
+	key->push_sz = info->push_sz;
+	key->state = info->state;
+	
+	return vlx_pipeline_hash(key);
+}
+
+static struct vlx_pipeline* vlx_pipeline_find(struct vlx_context* cntx, struct vlx_pipeline_key* key, uint64_t hash) {
+	for (struct vlx_pipeline* pipe = cntx->pipe[hash % VLX_PIPELINE_BUCKETS]; pipe != 0; pipe = pipe->next) {
+		if (pipe->hash == hash && memcmp(&(pipe->key), key, sizeof(struct vlx_pipeline_key)) == 0) {
+			pipe->ref++;
+			return pipe;
+		}
+	}
+	return 0;
+}
+
+static void vlx_pipeline_evict(struct vlx_context* cntx, const void* obj) {
+	for (uint32_t i = 0; i < VLX_PIPELINE_BUCKETS; i++) {
+		struct vlx_pipeline** prev = &(cntx->pipe[i]);
+		while (*prev != 0) {
+			struct vlx_pipeline* pipe = *prev;
+			if (pipe->key.srfc == obj || pipe->key.vrtx == obj || pipe->key.dscr == obj) {
+				*prev = pipe->next;
+				pipe->next = 0;
+			}
+			else prev = &(pipe->next);
+		}
+	}
+}
+
+static void vlx_pipeline_insert(struct vlx_context* cntx, struct vlx_pipeline* pipe, struct vlx_pipeline_key* key, uint64_t hash) {
+	pipe->key = *key;
+	pipe->hash = hash;
+	pipe->ref = 1;
+	pipe->next = cntx->pipe[hash % VLX_PIPELINE_BUCKETS];
+	cntx->pipe[hash % VLX_PIPELINE_BUCKETS] = pipe;
+}
+
+struct vlx_pipeline* vlx_pipeline_get(struct vlx_context* cntx, const struct vlx_pipeline_info* info) {
+	struct vlx_pipeline_key key;
+	uint64_t hash = vlx_pipeline_key(info, &key);
+	struct vlx_pipeline* pipe = vlx_pipeline_find(cntx, &key, hash);
+	if (pipe != 0) return pipe;
+	
+	pipe = vlx_pipeline_build(cntx, info);
+	vlx_pipeline_insert(cntx, pipe, &key, hash);
+	return pipe;
+}
+
+struct vlx_pipeline* vlx_pipeline_create(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_shader* shdv, struct vlx_shader* shdf, struct vlx_vertex* vrtx, struct vlx_descriptor* dscr, uint64_t push_sz) {
+	struct vlx_pipeline_info info;
+	memset(&info, 0, sizeof(struct vlx_pipeline_info));
+		info.srfc = srfc;
+		info.vert = shdv;
+		info.frag = shdf;
+		info.vrtx = vrtx;
+		info.dscr = dscr;
+		info.push_sz = push_sz;
+	return vlx_pipeline_get(cntx, &info);
+}
+
+struct vlx_pipeline* vlx_pipeline_compute(struct vlx_context* cntx, struct vlx_shader* shdc, struct vlx_descriptor* dscr, uint64_t push_sz) {
+	struct vlx_pipeline_key key;
+	memset(&key, 0, sizeof(struct vlx_pipeline_key));
+		key.vert = shdc->hash;
+		key.vert_sz = shdc->sz;
+		key.dscr = dscr;
+		key.push_sz = push_sz;
+	uint64_t hash = vlx_pipeline_hash(&key);
+	struct vlx_pipeline* pipe = vlx_pipeline_find(cntx, &key, hash);
+	if (pipe != 0) return pipe;
+	
+	uint64_t trce = vlx_trace_begin(cntx);
+	pipe = malloc(sizeof(struct vlx_pipeline));
+	pipe->bind = VK_PIPELINE_BIND_POINT_COMPUTE;
+	pipe->stg = VK_SHADER_STAGE_COMPUTE_BIT;
+	vlx_pipeline_layout(cntx, pipe, dscr, push_sz);
+	
+	VkComputePipelineCreateInfo pipeinfo;
+		pipeinfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipeinfo.pNext = 0;
+		pipeinfo.flags = 0;
+		pipeinfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipeinfo.stage.pNext = 0;
+		pipeinfo.stage.flags = 0;
+		pipeinfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipeinfo.stage.module = shdc->mod;
+		pipeinfo.stage.pName = "main";
+		pipeinfo.stage.pSpecializationInfo = 0;
+		pipeinfo.layout = pipe->layt;
+		pipeinfo.basePipelineHandle = 0;
+		pipeinfo.basePipelineIndex = 0;
+	vkCreateComputePipelines(cntx->devc, cntx->pipe_cache, 1, &pipeinfo, 0, &(pipe->pipe));
+	vlx_trace_end(cntx, "vlx_pipeline_compute", trce);
 	
+	vlx_pipeline_insert(cntx, pipe, &key, hash);
 	return pipe;
 }
 
+struct vlx_pipeline_batch {
+	struct vlx_context* cntx;
+	const struct vlx_pipeline_info* info;
+	struct vlx_pipeline** pipe;
+	uint32_t* miss;
+	uint32_t n;
+	uint32_t i;
+};
+
+static void* vlx_pipeline_work(void* arg) {
+	struct vlx_pipeline_batch* btch = arg;
+	for (uint32_t i = __atomic_fetch_add(&(btch->i), 1, __ATOMIC_RELAXED); i < btch->n; i = __atomic_fetch_add(&(btch->i), 1, __ATOMIC_RELAXED)) {
+		uint32_t j = btch->miss[i];
+		btch->pipe[j] = vlx_pipeline_build(btch->cntx, &(btch->info[j]));
+	}
+	return 0;
+}
+
+void vlx_pipeline_create_batch(struct vlx_context* cntx, const struct vlx_pipeline_info* info, uint32_t n, struct vlx_pipeline** pipe, uint32_t thrd_n) {
+	uint64_t trce = vlx_trace_begin(cntx);
+	struct vlx_pipeline_key* key = malloc(sizeof(struct vlx_pipeline_key) * n);
+	uint64_t* hash = malloc(sizeof(uint64_t) * n);
+	uint32_t* miss = malloc(sizeof(uint32_t) * n);
+	uint32_t miss_n = 0;
+	for (uint32_t i = 0; i < n; i++) {
+		hash[i] = vlx_pipeline_key(&(info[i]), &(key[i]));
+		pipe[i] = vlx_pipeline_find(cntx, &(key[i]), hash[i]);
+		if (pipe[i] == 0) miss[miss_n++] = i;
+	}
+	
+	if (thrd_n == 0) {
+		long cpu = sysconf(_SC_NPROCESSORS_ONLN);
+		thrd_n = (cpu > 0) ? cpu : 1;
+	}
+	if (thrd_n > miss_n) thrd_n = miss_n;
+	
+	struct vlx_pipeline_batch btch;
+		btch.cntx = cntx;
+		btch.info = info;
+		btch.pipe = pipe;
+		btch.miss = miss;
+		btch.n = miss_n;
+		btch.i = 0;
+	
+	pthread_t* thrd = malloc(sizeof(pthread_t) * (thrd_n + 1));
+	uint32_t spwn = 0;
+	for (uint32_t i = 1; i < thrd_n; i++) {
+		if (pthread_create(&(thrd[spwn]), 0, vlx_pipeline_work, &btch) == 0) spwn++;
+	}
+	vlx_pipeline_work(&btch);
+	for (uint32_t i = 0; i < spwn; i++) {
+		pthread_join(thrd[i], 0);
+	}
+	free(thrd);
+	
+	for (uint32_t i = 0; i < miss_n; i++) {
+		uint32_t j = miss[i];
+		struct vlx_pipeline* dup = vlx_pipeline_find(cntx, &(key[j]), hash[j]);
+		if (dup != 0) {
+			vkDestroyPipeline(cntx->devc, pipe[j]->pipe, 0);
+			vkDestroyPipelineLayout(cntx->devc, pipe[j]->layt, 0);
+			free(pipe[j]);
+			pipe[j] = dup;
+		}
+		else vlx_pipeline_insert(cntx, pipe[j], &(key[j]), hash[j]);
+	}
+	
+	free(miss);
+	free(hash);
+	free(key);
+	vlx_trace_end(cntx, "vlx_pipeline_create_batch", trce);
+}
+
+int8_t vlx_pipeline_cache_save(struct vlx_context* cntx) {
+	if (cntx->pipe_path == 0) return 0;
+	
+	size_t sz;
+	vkGetPipelineCacheData(cntx->devc, cntx->pipe_cache, &sz, 0);
+	uint8_t* data = malloc(sz);
+	vkGetPipelineCacheData(cntx->devc, cntx->pipe_cache, &sz, data);
+	
+	char* tmp = malloc(strlen(cntx->pipe_path) + 5);
+	sprintf(tmp, "%s.tmp", cntx->pipe_path);
+	int8_t ok = 0;
+	FILE* f = fopen(tmp, "wb");
+	if (f != 0) {
+		ok = fwrite(data, sz, 1, f) == 1;
+		ok = fflush(f) == 0 && fsync(fileno(f)) == 0 && ok;
+		ok = fclose(f) == 0 && ok;
+		if (ok) ok = rename(tmp, cntx->pipe_path) == 0;
+		if (!ok) remove(tmp);
+	}
+	
+	free(tmp);
+	free(data);
+	return ok;
+}
+
 void vlx_surface_init_frame_buffer(struct vlx_context* cntx, struct vlx_surface* srfc) {
 	VkImageView atch[2];
 	atch[1] = srfc->dpth.v;
@@ -584,43 +2253,31 @@ void vlx_surface_init_frame_buffer(struct vlx_context* cntx, struct vlx_surface*
 	}
 }
 
-void vlx_buffer_refresh(struct vlx_context* cntx, struct vlx_buffer* bfr, void* data, uint64_t sz) {
-	void* memdata;
-	vkMapMemory(cntx->devc, bfr->mem, 0, bfr->req.size, 0, &memdata);
-	memcpy(memdata, data, sz);
-	vkUnmapMemory(cntx->devc, bfr->mem);
-	vkBindBufferMemory(cntx->devc, bfr->bfr, bfr->mem, 0);
+void vlx_buffer_refresh(struct vlx_context* cntx, struct vlx_buffer* bfr, void* data, uint64_t sz, uint64_t off) {
+	if (bfr->mode == VLX_BUFFER_STATIC) vlx_upload_buffer(cntx, &(cntx->upld), bfr, data, sz, off);
+	else memcpy((uint8_t*) bfr->mem.map + vlx_buffer_region(cntx, bfr) + off, data, sz);
 }
 
-struct vlx_vertex* vlx_vertex_create(struct vlx_context* cntx, uint32_t b, uint32_t a, uint64_t sz) {
+struct vlx_vertex* vlx_vertex_create(struct vlx_context* cntx, uint32_t b, uint32_t a, uint64_t sz, uint8_t mode) {
 	struct vlx_vertex* vrtx = malloc(sizeof(struct vlx_vertex));
-	vrtx->bfr = malloc(sizeof(VkBuffer) * b);
-	vrtx->mem = malloc(sizeof(VkDeviceMemory) * b);
-	vrtx->req = malloc(sizeof(VkMemoryRequirements) * b);
+	vrtx->bfr = malloc(sizeof(struct vlx_buffer) * b);
 	vrtx->bind = malloc(sizeof(VkVertexInputBindingDescription) * b);
 	vrtx->b = b;
 	vrtx->attr = malloc(sizeof(VkVertexInputAttributeDescription) * a);
 	vrtx->a = a;
+	vrtx->div = malloc(sizeof(VkVertexInputBindingDivisorDescriptionEXT) * b);
+	vrtx->d = 0;
+	vrtx->gen = 0;
 	
 	for (uint32_t i = 0; i < b; i++) {
-		VkBufferCreateInfo bfrinfo;
-			bfrinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bfrinfo.pNext = 0;
-			bfrinfo.flags = 0;
-			bfrinfo.size = sz;
-			bfrinfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-			bfrinfo.sharingMode = 0;
-			bfrinfo.queueFamilyIndexCount = 1;
-			bfrinfo.pQueueFamilyIndices = &(cntx->que_i);
-		vkCreateBuffer(cntx->devc, &bfrinfo, 0, &(vrtx->bfr[i]));
-	
-		vkGetBufferMemoryRequirements(cntx->devc, vrtx->bfr[i], &(vrtx->req[i]));
-		VkMemoryAllocateInfo meminfo;
-			meminfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			meminfo.pNext = 0;
-			meminfo.allocationSize = vrtx->req[i].size;
-			meminfo.memoryTypeIndex = 0;
-		vkAllocateMemory(cntx->devc, &meminfo, 0, &(vrtx->mem[i]));
+		if (vlx_buffer_init(cntx, &(vrtx->bfr[i]), sz, mode, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)) continue;
+		while (i-- != 0) vlx_buffer_deinit(cntx, &(vrtx->bfr[i]));
+		free(vrtx->bfr);
+		free(vrtx->bind);
+		free(vrtx->attr);
+		free(vrtx->div);
+		free(vrtx);
+		return 0;
 	}
 	return vrtx;
 }
@@ -631,6 +2288,21 @@ void vlx_vertex_bind(struct vlx_vertex* vrtx, uint32_t b, uint32_t s) {
 	vrtx->bind[b].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 }
 
+void vlx_vertex_bind_instance(struct vlx_vertex* vrtx, uint32_t b, uint32_t s, uint32_t div) {
+	vrtx->bind[b].binding = b;
+	vrtx->bind[b].stride = s;
+	vrtx->bind[b].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+	
+	uint32_t i = 0;
+	while (i < vrtx->d && vrtx->div[i].binding != b) i++;
+	if (div > 1) {
+		vrtx->div[i].binding = b;
+		vrtx->div[i].divisor = div;
+		if (i == vrtx->d) vrtx->d++;
+	}
+	else if (i < vrtx->d) vrtx->div[i] = vrtx->div[--vrtx->d];
+}
+
 void vlx_vertex_attr(struct vlx_vertex* vrtx, uint32_t l, uint32_t b, int8_t sz, uint32_t off) {
 	vrtx->attr[l].location = l;
 	vrtx->attr[l].binding = b;
@@ -653,183 +2325,128 @@ void vlx_vertex_conf(struct vlx_vertex* vrtx) {
 	vrtx->in.pVertexBindingDescriptions = vrtx->bind;
 	vrtx->in.vertexAttributeDescriptionCount = vrtx->a;
 	vrtx->in.pVertexAttributeDescriptions = vrtx->attr;
+	
+	vrtx->div_in.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT;
+	vrtx->div_in.pNext = 0;
+	vrtx->div_in.vertexBindingDivisorCount = vrtx->d;
+	vrtx->div_in.pVertexBindingDivisors = vrtx->div;
+	vrtx->gen++;
 }
 
-void vlx_vertex_refresh(struct vlx_context* cntx, struct vlx_vertex* vrtx, uint32_t b, void* data, uint64_t sz) {
-	void* memdata;
-	vkMapMemory(cntx->devc, vrtx->mem[b], 0, vrtx->req[b].size, 0, &memdata);
-	memcpy(memdata, data, sz);
-	vkUnmapMemory(cntx->devc, vrtx->mem[b]);
-	vkBindBufferMemory(cntx->devc, vrtx->bfr[b], vrtx->mem[b], 0);
+int8_t vlx_vertex_instance(struct vlx_context* cntx, struct vlx_vertex* vrtx, uint32_t b, uint32_t l, uint32_t n) {
+	struct vlx_buffer inst;
+	if (!vlx_buffer_init(cntx, &inst, (uint64_t) n * 64, VLX_BUFFER_STREAM, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)) return 0;
+	vlx_buffer_deinit(cntx, &(vrtx->bfr[b]));
+	vrtx->bfr[b] = inst;
+	vlx_vertex_bind_instance(vrtx, b, 64, 1);
+	for (uint32_t i = 0; i < 4; i++) {
+		vrtx->attr[l + i].location = l + i;
+		vrtx->attr[l + i].binding = b;
+		vrtx->attr[l + i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		vrtx->attr[l + i].offset = 16 * i;
+	}
+	vrtx->gen++;
+	return 1;
 }
 
-struct vlx_buffer* vlx_index_create(struct vlx_context* cntx, uint64_t sz) {
-	struct vlx_buffer* indx = malloc(sizeof(struct vlx_buffer));
+void vlx_vertex_refresh(struct vlx_context* cntx, struct vlx_vertex* vrtx, uint32_t b, void* data, uint64_t sz, uint64_t off) {
+	vlx_buffer_refresh(cntx, &(vrtx->bfr[b]), data, sz, off);
+}
 
-	VkBufferCreateInfo bfrinfo;
-		bfrinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bfrinfo.pNext = 0;
-		bfrinfo.flags = 0;
-		bfrinfo.size = sz;
-		bfrinfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-		bfrinfo.sharingMode = 0;
-		bfrinfo.queueFamilyIndexCount = 1;
-		bfrinfo.pQueueFamilyIndices = &(cntx->que_i);
-	vkCreateBuffer(cntx->devc, &bfrinfo, 0, &(indx->bfr));
-	
-	vkGetBufferMemoryRequirements(cntx->devc, indx->bfr, &(indx->req));
-	VkMemoryAllocateInfo meminfo;
-		meminfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		meminfo.pNext = 0;
-		meminfo.allocationSize = indx->req.size;
-		meminfo.memoryTypeIndex = 0;
-	vkAllocateMemory(cntx->devc, &meminfo, 0, &(indx->mem));
+struct vlx_buffer* vlx_vertex_buffer(struct vlx_vertex* vrtx, uint32_t b) {
+	return &(vrtx->bfr[b]);
+}
+
+struct vlx_buffer* vlx_index_create(struct vlx_context* cntx, uint64_t sz, uint8_t mode) {
+	struct vlx_buffer* indx = malloc(sizeof(struct vlx_buffer));
+	
+	if (!vlx_buffer_init(cntx, indx, sz, mode, VK_BUFFER_USAGE_INDEX_BUFFER_BIT)) {
+		free(indx);
+		return 0;
+	}
 	
 	return indx;
 }
 
+struct vlx_buffer* vlx_indirect_create(struct vlx_context* cntx, uint64_t sz, uint8_t mode) {
+	struct vlx_buffer* drw = malloc(sizeof(struct vlx_buffer));
+	
+	if (!vlx_buffer_init(cntx, drw, sz, mode, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)) {
+		free(drw);
+		return 0;
+	}
+	
+	return drw;
+}
+
+struct vlx_buffer* vlx_storage_create(struct vlx_context* cntx, uint64_t sz, uint8_t mode) {
+	struct vlx_buffer* strg = malloc(sizeof(struct vlx_buffer));
+	
+	if (!vlx_buffer_init(cntx, strg, sz, mode, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT)) {
+		free(strg);
+		return 0;
+	}
+	
+	return strg;
+}
+
 struct vlx_buffer* vlx_uniform_create(struct vlx_context* cntx, uint64_t sz) {
 	struct vlx_buffer* unif = malloc(sizeof(struct vlx_buffer));
-
-	VkBufferCreateInfo bfrinfo;
-		bfrinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bfrinfo.pNext = 0;
-		bfrinfo.flags = 0;
-		bfrinfo.size = sz;
-		bfrinfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-		bfrinfo.sharingMode = 0;
-		bfrinfo.queueFamilyIndexCount = 1;
-		bfrinfo.pQueueFamilyIndices = &(cntx->que_i);
-	vkCreateBuffer(cntx->devc, &bfrinfo, 0, &(unif->bfr));
-	
-	vkGetBufferMemoryRequirements(cntx->devc, unif->bfr, &(unif->req));
-	VkMemoryAllocateInfo meminfo;
-		meminfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		meminfo.pNext = 0;
-		meminfo.allocationSize = unif->req.size;
-		meminfo.memoryTypeIndex = 0;
-	vkAllocateMemory(cntx->devc, &meminfo, 0, &(unif->mem));
+	
+	if (!vlx_buffer_init(cntx, unif, sz, VLX_BUFFER_STREAM, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)) {
+		free(unif);
+		return 0;
+	}
 	
 	return unif;
 }
 
-struct vlx_texture* vlx_texture_create(struct vlx_context* cntx, struct vlx_command* cmd, uint8_t* pix, uint32_t w, uint32_t h) {
-	struct vlx_texture* txtr = malloc(sizeof(struct vlx_texture));
-	struct vlx_buffer bfr;
+void vlx_upload_flush(struct vlx_context* cntx) {
+	vlx_transfer_flush(cntx, &(cntx->upld));
+	vlx_transfer_flush(cntx, &(cntx->txup));
+}
 
-	VkBufferCreateInfo bfrinfo;
-		bfrinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bfrinfo.pNext = 0;
-		bfrinfo.flags = 0;
-		bfrinfo.size = w * h * 4;
-		bfrinfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-		bfrinfo.sharingMode = 0;
-		bfrinfo.queueFamilyIndexCount = 1;
-		bfrinfo.pQueueFamilyIndices = &(cntx->que_i);
-	vkCreateBuffer(cntx->devc, &bfrinfo, 0, &(bfr.bfr));
-	
-	vkGetBufferMemoryRequirements(cntx->devc, bfr.bfr, &(bfr.req));
-	VkMemoryAllocateInfo meminfo;
-		meminfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		meminfo.pNext = 0;
-		meminfo.allocationSize = bfr.req.size;
-		meminfo.memoryTypeIndex = 0;
-	vkAllocateMemory(cntx->devc, &meminfo, 0, &(bfr.mem));
-	
-	vlx_buffer_refresh(cntx, &(bfr), pix, w * h * 4);
+int8_t vlx_format_supported(struct vlx_context* cntx, uint8_t frmt) {
+	if (frmt >= VLX_FORMAT_N) return 0;
+	VkFormatProperties frmtprop;
+	vkGetPhysicalDeviceFormatProperties(cntx->gpu, vlx_format[frmt].frmt, &frmtprop);
+	return (frmtprop.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
+static struct vlx_texture* vlx_texture_init(struct vlx_context* cntx, struct vlx_transfer* xfr, VkFormat frmt, uint32_t w, uint32_t h, uint32_t lvl, VkImageUsageFlags use) {
+	struct vlx_texture* txtr = malloc(sizeof(struct vlx_texture));
+	txtr->lay = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	txtr->xfr = xfr;
 	
+	uint32_t fam[3];
 	VkImageCreateInfo imginfo;
 		imginfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 		imginfo.pNext = 0;
 		imginfo.flags = 0;
 		imginfo.imageType = VK_IMAGE_TYPE_2D;
-		imginfo.format = cntx->txtr_frmt;
+		imginfo.format = frmt;
 		imginfo.extent.width = w;
 		imginfo.extent.height = h;
 		imginfo.extent.depth = 1;
-		imginfo.mipLevels = 1;
+		imginfo.mipLevels = lvl;
 		imginfo.arrayLayers = 1;
 		imginfo.samples = VK_SAMPLE_COUNT_1_BIT;
 		imginfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-		imginfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		imginfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | use;
 		imginfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		imginfo.queueFamilyIndexCount = 1;
-		imginfo.pQueueFamilyIndices = &(cntx->que_i);
+		imginfo.queueFamilyIndexCount = vlx_family(cntx, txtr->xfr->que_i, fam);
+		imginfo.pQueueFamilyIndices = fam;
 		imginfo.initialLayout = 0;
+	if (imginfo.queueFamilyIndexCount > 1) imginfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
 	vkCreateImage(cntx->devc, &imginfo, 0, &(txtr->img.img));
 	
 	vkGetImageMemoryRequirements(cntx->devc, txtr->img.img, &(txtr->img.req));
-		meminfo.allocationSize = txtr->img.req.size;
-	vkAllocateMemory(cntx->devc, &meminfo, 0, &(txtr->img.mem));
-	vkBindImageMemory(cntx->devc, txtr->img.img, txtr->img.mem, 0);
-	
-	VkCommandBuffer cmd_txtr;
-	VkCommandBufferAllocateInfo cmdinfo;
-		cmdinfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		cmdinfo.pNext = 0;
-		cmdinfo.commandPool = cmd->pool;
-		cmdinfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		cmdinfo.commandBufferCount = 1;
-	vkAllocateCommandBuffers(cntx->devc, &cmdinfo, &cmd_txtr);
-	
-	VkCommandBufferBeginInfo cbfrinfo;
-		cbfrinfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		cbfrinfo.pNext = 0;
-		cbfrinfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-		cbfrinfo.pInheritanceInfo = 0;
-	vkBeginCommandBuffer(cmd_txtr, &cbfrinfo);
-	
-	VkImageMemoryBarrier imgmembar;
-		imgmembar.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		imgmembar.pNext = 0;
-		imgmembar.srcAccessMask = 0;
-		imgmembar.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		imgmembar.oldLayout = 0;
-		imgmembar.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		imgmembar.srcQueueFamilyIndex = cntx->que_i;
-		imgmembar.dstQueueFamilyIndex = cntx->que_i;
-		imgmembar.image = txtr->img.img;
-		imgmembar.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		imgmembar.subresourceRange.baseMipLevel = 0;
-		imgmembar.subresourceRange.levelCount = 1;
-		imgmembar.subresourceRange.baseArrayLayer = 0;
-		imgmembar.subresourceRange.layerCount = 1;
-	vkCmdPipelineBarrier(cmd_txtr, 0, 0, 0, 0, 0, 0, 0, 1, &imgmembar);
-	
-	VkBufferImageCopy cp;
-		cp.bufferOffset = 0;
-		cp.bufferRowLength = 0;
-		cp.bufferImageHeight = 0;
-		cp.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		cp.imageSubresource.mipLevel = 0;
-		cp.imageSubresource.baseArrayLayer = 0;
-		cp.imageSubresource.layerCount = 1;
-		cp.imageOffset.x = 0;
-		cp.imageOffset.y = 0;
-		cp.imageOffset.z = 0;
-		cp.imageExtent.width = w;
-		cp.imageExtent.height = h;
-		cp.imageExtent.depth = 1;
-	vkCmdCopyBufferToImage(cmd_txtr, bfr.bfr, txtr->img.img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &cp);
-	
-	vkEndCommandBuffer(cmd_txtr);
-	
-	VkSubmitInfo sbmtinfo;
-		sbmtinfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		sbmtinfo.pNext = 0;
-		sbmtinfo.waitSemaphoreCount = 0;
-		sbmtinfo.pWaitSemaphores = 0;
-		sbmtinfo.pWaitDstStageMask = 0;
-		sbmtinfo.commandBufferCount = 1;
-		sbmtinfo.pCommandBuffers = &cmd_txtr;
-		sbmtinfo.signalSemaphoreCount = 0;
-		sbmtinfo.pSignalSemaphores = 0;
-	vkQueueSubmit(cntx->que, 1, &sbmtinfo, cntx->fnc);
-	
-	vkWaitForFences(cntx->devc, 1, &(cntx->fnc), 1, UINT64_MAX);
-	vkResetFences(cntx->devc, 1, &(cntx->fnc));
-	
-	vkFreeCommandBuffers(cntx->devc, cmd->pool, 1, &cmd_txtr);
+	if (!vlx_memory_alloc(cntx, &(txtr->img.req), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, 0, &(txtr->img.mem))) {
+		vkDestroyImage(cntx->devc, txtr->img.img, 0);
+		free(txtr);
+		return 0;
+	}
+	vkBindImageMemory(cntx->devc, txtr->img.img, txtr->img.mem.blck->mem, txtr->img.mem.off);
 	
 	VkImageViewCreateInfo imgvinfo;
 		imgvinfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -837,14 +2454,14 @@ struct vlx_texture* vlx_texture_create(struct vlx_context* cntx, struct vlx_comm
 		imgvinfo.flags = 0;
 		imgvinfo.image = txtr->img.img;
 		imgvinfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-		imgvinfo.format = cntx->txtr_frmt;
+		imgvinfo.format = frmt;
 		imgvinfo.components.r = 0;
 		imgvinfo.components.g = 0;
 		imgvinfo.components.b = 0;
 		imgvinfo.components.a = 0;
 		imgvinfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 		imgvinfo.subresourceRange.baseMipLevel = 0;
-		imgvinfo.subresourceRange.levelCount = 1;
+		imgvinfo.subresourceRange.levelCount = lvl;
 		imgvinfo.subresourceRange.baseArrayLayer = 0;
 		imgvinfo.subresourceRange.layerCount = 1;
 	vkCreateImageView(cntx->devc, &imgvinfo, 0, &(txtr->img.v));
@@ -865,53 +2482,243 @@ struct vlx_texture* vlx_texture_create(struct vlx_context* cntx, struct vlx_comm
 		smplinfo.compareEnable = 0;
 		smplinfo.compareOp = VK_COMPARE_OP_ALWAYS;
 		smplinfo.minLod = 0.f;
-		smplinfo.maxLod = 0.f;
+		smplinfo.maxLod = lvl - 1;
 		smplinfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 		smplinfo.unnormalizedCoordinates = 0;
+	if (lvl > 1) {
+			smplinfo.magFilter = VK_FILTER_LINEAR;
+			smplinfo.minFilter = VK_FILTER_LINEAR;
+		if (cntx->feat.samplerAnisotropy) {
+				smplinfo.anisotropyEnable = 1;
+				smplinfo.maxAnisotropy = cntx->prop.limits.maxSamplerAnisotropy;
+		}
+	}
 	vkCreateSampler(cntx->devc, &smplinfo, 0, &(txtr->smpl));
 	
-	vkDestroyBuffer(cntx->devc, bfr.bfr, 0);
-	vkFreeMemory(cntx->devc, bfr.mem, 0);
+	return txtr;
+}
+
+struct vlx_texture* vlx_texture_load(struct vlx_context* cntx, uint8_t* pix, uint32_t w, uint32_t h, uint8_t mip) {
+	uint64_t trce = vlx_trace_begin(cntx);
+	struct vlx_transfer* xfr = &(cntx->txup);
+	uint32_t lvl = 1;
+	if (mip) {
+		VkFormatProperties frmtprop;
+		vkGetPhysicalDeviceFormatProperties(cntx->gpu, cntx->txtr_frmt, &frmtprop);
+		VkFormatFeatureFlags need = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		if ((frmtprop.optimalTilingFeatures & need) == need) {
+			lvl = vlx_log2(((w > h) ? w : h) + 1);
+			xfr = &(cntx->upld);
+		}
+	}
+	
+	struct vlx_texture* txtr = vlx_texture_init(cntx, xfr, cntx->txtr_frmt, w, h, lvl, (lvl > 1) ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
+	if (txtr == 0) {
+		vlx_trace_end(cntx, "vlx_texture_load", trce);
+		return 0;
+	}
+	vlx_upload_image(cntx, txtr->xfr, txtr->img.img, pix, w, h, 0, w * 4, 1, 1, 1, lvl);
+	txtr->id = txtr->xfr->sbmt + 1;
+	vlx_trace_end(cntx, "vlx_texture_load", trce);
 	
 	return txtr;
 }
-struct vlx_descriptor* vlx_descriptor_create(struct vlx_context* cntx, uint32_t n) {
+
+struct vlx_texture* vlx_texture_file(struct vlx_context* cntx, const char* path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return 0;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < 128) {
+		close(fd);
+		return 0;
+	}
+	uint64_t sz = st.st_size;
+	uint8_t* map = mmap(0, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return 0;
+	
+	static const uint8_t ktx2[12] = {0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n'};
+	uint32_t f = UINT32_MAX;
+	uint8_t srgb = 0;
+	uint32_t w = 0;
+	uint32_t h = 0;
+	uint32_t lvl = 0;
+	uint64_t off[32];
+	uint64_t len[32];
+	
+	if (memcmp(map, ktx2, 12) == 0) {
+		uint32_t* hdr = (uint32_t*) map;
+		VkFormat frmt = hdr[3];
+		w = hdr[5];
+		h = hdr[6];
+		lvl = hdr[10] ? hdr[10] : 1;
+		for (uint32_t i = 0; i < VLX_FORMAT_N + VLX_FORMAT_X; i++) {
+			if (vlx_format[i].frmt == frmt) f = i;
+			else if (vlx_format[i].srgb == frmt && frmt != vlx_format[i].frmt) {
+				f = i;
+				srgb = 1;
+			}
+		}
+		if (hdr[7] > 1 || hdr[8] > 1 || hdr[9] > 1 || hdr[11] != 0 || lvl > 32 || 80 + 24 * (uint64_t) lvl > sz) f = UINT32_MAX;
+		for (uint32_t i = 0; i < lvl && f != UINT32_MAX; i++) {
+			uint64_t* idx = (uint64_t*) (map + 80 + 24 * i);
+			off[i] = idx[0];
+			len[i] = idx[1];
+		}
+	}
+	else if (memcmp(map, "DDS ", 4) == 0) {
+		uint32_t* hdr = (uint32_t*) map;
+		h = hdr[3];
+		w = hdr[4];
+		lvl = hdr[7] ? hdr[7] : 1;
+		uint64_t pos = 128;
+		uint8_t* cc = map + 84;
+		if (memcmp(cc, "DX10", 4) == 0 && sz >= 148) {
+			uint32_t dxgi = hdr[32];
+			if (dxgi == 28 || dxgi == 29) f = VLX_FORMAT_RGBA8;
+			if (dxgi == 71 || dxgi == 72) f = VLX_FORMAT_BC1;
+			if (dxgi == 77 || dxgi == 78) f = VLX_FORMAT_BC3;
+			if (dxgi == 80) f = VLX_FORMAT_BC4;
+			if (dxgi == 83) f = VLX_FORMAT_BC5;
+			if (dxgi == 98 || dxgi == 99) f = VLX_FORMAT_BC7;
+			srgb = dxgi == 29 || dxgi == 72 || dxgi == 78 || dxgi == 99;
+			if (hdr[33] != 3 || (hdr[34] & 0x4) || hdr[35] > 1) f = UINT32_MAX;
+			pos = 148;
+		}
+		else {
+			if (memcmp(cc, "DXT1", 4) == 0) f = VLX_FORMAT_BC1;
+			if (memcmp(cc, "DXT5", 4) == 0) f = VLX_FORMAT_BC3;
+			if (memcmp(cc, "ATI1", 4) == 0 || memcmp(cc, "BC4U", 4) == 0) f = VLX_FORMAT_BC4;
+			if (memcmp(cc, "ATI2", 4) == 0 || memcmp(cc, "BC5U", 4) == 0) f = VLX_FORMAT_BC5;
+			if ((hdr[20] & 0x40) && hdr[22] == 32 && hdr[23] == 0x000000ff && hdr[24] == 0x0000ff00 && hdr[25] == 0x00ff0000) f = VLX_FORMAT_RGBA8;
+			srgb = cntx->txtr_frmt == VK_FORMAT_R8G8B8A8_SRGB;
+		}
+		if (lvl > 32 || (hdr[28] & 0x200) || (hdr[28] & 0x200000) || ((hdr[2] & 0x800000) && hdr[6] > 1)) f = UINT32_MAX;
+		for (uint32_t i = 0; i < lvl && f != UINT32_MAX; i++) {
+			const struct vlx_format* blk = &(vlx_format[f]);
+			uint32_t mw = (w >> i) ? (w >> i) : 1;
+			uint32_t mh = (h >> i) ? (h >> i) : 1;
+			off[i] = pos;
+			len[i] = (uint64_t) ((mw + blk->bw - 1) / blk->bw) * blk->bs * ((mh + blk->bh - 1) / blk->bh);
+			pos += len[i];
+		}
+	}
+	
+	uint32_t dim = cntx->prop.limits.maxImageDimension2D;
+	if (w == 0 || h == 0 || w > dim || h > dim || lvl > vlx_log2(((w > h) ? w : h) + (uint64_t) 1)) f = UINT32_MAX;
+	
+	VkFormat frmt = 0;
+	if (f != UINT32_MAX) {
+		frmt = srgb ? vlx_format[f].srgb : vlx_format[f].frmt;
+		VkFormatProperties frmtprop;
+		vkGetPhysicalDeviceFormatProperties(cntx->gpu, frmt, &frmtprop);
+		if (!(frmtprop.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) f = UINT32_MAX;
+	}
+	for (uint32_t i = 0; i < lvl && f != UINT32_MAX; i++) {
+		const struct vlx_format* blk = &(vlx_format[f]);
+		uint32_t mw = (w >> i) ? (w >> i) : 1;
+		uint32_t mh = (h >> i) ? (h >> i) : 1;
+		uint64_t need = (uint64_t) ((mw + blk->bw - 1) / blk->bw) * blk->bs * ((mh + blk->bh - 1) / blk->bh);
+		if (off[i] > sz || len[i] > sz - off[i] || len[i] < need) f = UINT32_MAX;
+	}
+	if (f == UINT32_MAX) {
+		munmap(map, sz);
+		return 0;
+	}
+	
+	const struct vlx_format* blk = &(vlx_format[f]);
+	struct vlx_texture* txtr = vlx_texture_init(cntx, &(cntx->txup), frmt, w, h, lvl, 0);
+	if (txtr == 0) {
+		munmap(map, sz);
+		return 0;
+	}
+	for (uint32_t i = 0; i < lvl; i++) {
+		uint32_t mw = (w >> i) ? (w >> i) : 1;
+		uint32_t mh = (h >> i) ? (h >> i) : 1;
+		uint32_t bpr = ((mw + blk->bw - 1) / blk->bw) * blk->bs;
+		vlx_upload_image(cntx, txtr->xfr, txtr->img.img, map + off[i], mw, mh, i, bpr, blk->bh, i == 0, i == lvl - 1, 0);
+	}
+	txtr->id = txtr->xfr->sbmt + 1;
+	munmap(map, sz);
+	
+	return txtr;
+}
+
+struct vlx_texture* vlx_texture_storage(struct vlx_context* cntx, uint32_t w, uint32_t h, uint8_t frmt) {
+	if (frmt >= VLX_FORMAT_N) return 0;
+	VkFormatProperties frmtprop;
+	vkGetPhysicalDeviceFormatProperties(cntx->gpu, vlx_format[frmt].frmt, &frmtprop);
+	if (!(frmtprop.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) return 0;
+	
+	struct vlx_texture* txtr = vlx_texture_init(cntx, &(cntx->upld), vlx_format[frmt].frmt, w, h, 1, VK_IMAGE_USAGE_STORAGE_BIT);
+	if (txtr == 0) return 0;
+	txtr->lay = VK_IMAGE_LAYOUT_GENERAL;
+	vlx_upload_layout(cntx, txtr->xfr, txtr->img.img, txtr->lay);
+	txtr->id = txtr->xfr->sbmt + 1;
+	
+	return txtr;
+}
+
+int8_t vlx_texture_ready(struct vlx_context* cntx, struct vlx_texture* txtr) {
+	if (txtr->xfr->done < txtr->id) vlx_transfer_poll(cntx, txtr->xfr);
+	return txtr->xfr->done >= txtr->id;
+}
+
+struct vlx_texture* vlx_texture_create(struct vlx_context* cntx, struct vlx_command* cmd, uint8_t* pix, uint32_t w, uint32_t h, uint8_t mip) {
+	uint64_t trce = vlx_trace_begin(cntx);
+	struct vlx_texture* txtr = vlx_texture_load(cntx, pix, w, h, mip);
+	if (txtr != 0) vlx_transfer_wait(cntx, txtr->xfr, txtr->id);
+	vlx_trace_end(cntx, "vlx_texture_create", trce);
+	
+	return txtr;
+}
+
+struct vlx_descriptor* vlx_descriptor_layout(struct vlx_context* cntx, uint32_t n, const uint8_t* type, uint32_t t) {
+	static const VkDescriptorType vktype[4] = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE};
 	struct vlx_descriptor* dscr = malloc(sizeof	(struct vlx_descriptor));
 	dscr->set = malloc(sizeof(VkDescriptorSet) * n);
 	dscr->layt = malloc(sizeof(VkDescriptorSetLayout) * n);
 	dscr->n = n;
-	
-	VkDescriptorPoolSize poolsz[2];
-		poolsz[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolsz[0].descriptorCount = n;
-		poolsz[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		poolsz[1].descriptorCount = n;
+	dscr->type = malloc(sizeof(VkDescriptorType) * t);
+	dscr->t = t;
+	dscr->bind = calloc(n * t, sizeof(void*));
+	
+	VkDescriptorPoolSize poolsz[4];
+	uint32_t poolszn = 0;
+	for (uint32_t i = 0; i < 4; i++) {
+		uint32_t cnt = 0;
+		for (uint32_t j = 0; j < t; j++) {
+			if (type[j] == i) cnt++;
+		}
+		if (cnt == 0) continue;
+		poolsz[poolszn].type = vktype[i];
+		poolsz[poolszn].descriptorCount = cnt * n;
+		poolszn++;
+	}
 	VkDescriptorPoolCreateInfo poolinfo;
 		poolinfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 		poolinfo.pNext = 0;
 		poolinfo.flags = 0;
 		poolinfo.maxSets = n;
-		poolinfo.poolSizeCount = 2;
+		poolinfo.poolSizeCount = poolszn;
 		poolinfo.pPoolSizes = poolsz;
 	vkCreateDescriptorPool(cntx->devc, &poolinfo, 0, &(dscr->pool));
 	
-	VkDescriptorSetLayoutBinding bind[2];
-		bind[0].binding = 0;
-		bind[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		bind[0].descriptorCount = 1;
-		bind[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		bind[0].pImmutableSamplers = 0;
-		bind[1].binding = 1;
-		bind[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		bind[1].descriptorCount = 1;
-		bind[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		bind[1].pImmutableSamplers = 0;
+	VkDescriptorSetLayoutBinding bind[t];
+	for (uint32_t i = 0; i < t; i++) {
+		dscr->type[i] = vktype[type[i]];
+		bind[i].binding = i;
+		bind[i].descriptorType = dscr->type[i];
+		bind[i].descriptorCount = 1;
+		bind[i].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+		bind[i].pImmutableSamplers = 0;
+	}
 	
 	VkDescriptorSetLayoutCreateInfo laytinfo;
 		laytinfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 		laytinfo.pNext = 0;
 		laytinfo.flags = 0;
-		laytinfo.bindingCount = 2;
+		laytinfo.bindingCount = t;
 		laytinfo.pBindings = bind;
 	for (uint32_t i = 0; i < n; i++) {
 		vkCreateDescriptorSetLayout(cntx->devc, &laytinfo, 0, &(dscr->layt[i]));
@@ -927,16 +2734,28 @@ struct vlx_descriptor* vlx_descriptor_create(struct vlx_context* cntx, uint32_t
 	return dscr;
 }
 
+struct vlx_descriptor* vlx_descriptor_create(struct vlx_context* cntx, uint32_t n) {
+	uint8_t type[2] = {VLX_DESCRIPTOR_UNIFORM, VLX_DESCRIPTOR_TEXTURE};
+	return vlx_descriptor_layout(cntx, n, type, 2);
+}
+
 void vlx_dsecriptor_write(struct vlx_context* cntx, struct vlx_descriptor* dscr, uint32_t i, struct vlx_buffer* unif, void* data, uint64_t sz, struct vlx_texture* txtr) {
 	VkWriteDescriptorSet writ[2];
 	uint8_t n = 0;
 	
 	VkDescriptorBufferInfo bfr;
-	if (unif != 0) {
+	if (unif != 0 && !unif->init && unif->mode == VLX_BUFFER_STREAM) {
+		for (uint32_t j = 0; j < unif->rng_n; j++) {
+			memcpy((uint8_t*) unif->mem.map + j * unif->sz, data, sz);
+		}
+		unif->init = 1;
+	}
+	else if (unif != 0) vlx_buffer_refresh(cntx, unif, data, sz, 0);
+	if (unif != 0 && dscr->bind[i * dscr->t] != unif) {
 		bfr.buffer = unif->bfr;
 		bfr.offset = 0;
-		bfr.range = sz;
-		vlx_buffer_refresh(cntx, unif, data, sz);
+		bfr.range = unif->sz;
+		dscr->bind[i * dscr->t] = unif;
 		
 		writ[n].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 		writ[n].pNext = 0;
@@ -944,7 +2763,7 @@ void vlx_dsecriptor_write(struct vlx_context* cntx, struct vlx_descriptor* dscr,
 		writ[n].dstBinding = 0;
 		writ[n].dstArrayElement = 0;
 		writ[n].descriptorCount = 1;
-		writ[n].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		writ[n].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 		writ[n].pImageInfo = 0;
 		writ[n].pBufferInfo = &bfr;
 		writ[n].pTexelBufferView = 0;
@@ -952,10 +2771,11 @@ void vlx_dsecriptor_write(struct vlx_context* cntx, struct vlx_descriptor* dscr,
 	}
 	
 	VkDescriptorImageInfo img;
-	if (txtr != 0) {
+	if (txtr != 0 && dscr->bind[i * dscr->t + 1] != txtr) {
+		dscr->bind[i * dscr->t + 1] = txtr;
 		img.sampler = txtr->smpl;
 		img.imageView = txtr->img.v;
-		img.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		img.imageLayout = txtr->lay;
 		
 		writ[n].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 		writ[n].pNext = 0;
@@ -970,7 +2790,50 @@ void vlx_dsecriptor_write(struct vlx_context* cntx, struct vlx_descriptor* dscr,
 		n++;
 	}
 	
-	vkUpdateDescriptorSets(cntx->devc, n, writ, 0, 0);
+	if (n != 0) vkUpdateDescriptorSets(cntx->devc, n, writ, 0, 0);
+}
+
+void vlx_descriptor_buffer(struct vlx_context* cntx, struct vlx_descriptor* dscr, uint32_t i, uint32_t b, struct vlx_buffer* bfr, uint64_t off, uint64_t sz) {
+	VkDescriptorBufferInfo bfrinfo;
+		bfrinfo.buffer = bfr->bfr;
+		bfrinfo.offset = off;
+		bfrinfo.range = (sz != 0) ? sz : VK_WHOLE_SIZE;
+	if (dscr->type[b] == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC && sz == 0) bfrinfo.range = bfr->sz - off;
+	dscr->bind[i * dscr->t + b] = bfr;
+	
+	VkWriteDescriptorSet writ;
+		writ.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writ.pNext = 0;
+		writ.dstSet = dscr->set[i];
+		writ.dstBinding = b;
+		writ.dstArrayElement = 0;
+		writ.descriptorCount = 1;
+		writ.descriptorType = dscr->type[b];
+		writ.pImageInfo = 0;
+		writ.pBufferInfo = &bfrinfo;
+		writ.pTexelBufferView = 0;
+	vkUpdateDescriptorSets(cntx->devc, 1, &writ, 0, 0);
+}
+
+void vlx_descriptor_image(struct vlx_context* cntx, struct vlx_descriptor* dscr, uint32_t i, uint32_t b, struct vlx_texture* txtr) {
+	VkDescriptorImageInfo img;
+		img.sampler = txtr->smpl;
+		img.imageView = txtr->img.v;
+		img.imageLayout = txtr->lay;
+	dscr->bind[i * dscr->t + b] = txtr;
+	
+	VkWriteDescriptorSet writ;
+		writ.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writ.pNext = 0;
+		writ.dstSet = dscr->set[i];
+		writ.dstBinding = b;
+		writ.dstArrayElement = 0;
+		writ.descriptorCount = 1;
+		writ.descriptorType = dscr->type[b];
+		writ.pImageInfo = &img;
+		writ.pBufferInfo = 0;
+		writ.pTexelBufferView = 0;
+	vkUpdateDescriptorSets(cntx->devc, 1, &writ, 0, 0);
 }
 
 void vlx_surface_clear(struct vlx_surface* srfc, uint8_t r, uint8_t g, uint8_t b) {
@@ -982,15 +2845,223 @@ void vlx_surface_clear(struct vlx_surface* srfc, uint8_t r, uint8_t g, uint8_t b
 	srfc->clr[1].depthStencil.stencil = 0;
 }
 
-void vlx_surface_new_frame(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd) {
-	vkAcquireNextImageKHR(cntx->devc, srfc->swap, UINT64_MAX, cntx->smph_img, 0, &(srfc->img_i));
+static void vlx_ring_push(struct vlx_ring* ring, double v) {
+	ring->smpl[ring->i] = v;
+	ring->i = (ring->i + 1) % VLX_PROFILE_N;
+	if (ring->n < VLX_PROFILE_N) ring->n++;
+}
+
+static int vlx_ring_cmp(const void* a, const void* b) {
+	double x = *(const double*) a;
+	double y = *(const double*) b;
+	return (x > y) - (x < y);
+}
+
+struct vlx_profile* vlx_profile_create(struct vlx_context* cntx, struct vlx_surface* srfc, uint32_t scp_cap) {
+	struct vlx_profile* prof = calloc(1, sizeof(struct vlx_profile));
+	prof->srfc = srfc;
+	prof->scp_cap = scp_cap;
+	prof->name = calloc(scp_cap + 1, sizeof(char*));
+	prof->used = calloc(cntx->frm_n * (scp_cap + 1), sizeof(uint8_t));
+	prof->ring = calloc(VLX_PROFILE_SCOPE + scp_cap, sizeof(struct vlx_ring));
+	prof->prd = cntx->prop.limits.timestampPeriod;
+	prof->t_sbmt = calloc(cntx->frm_n, sizeof(uint64_t));
+	
+	uint32_t quen;
+	vkGetPhysicalDeviceQueueFamilyProperties(cntx->gpu, &quen, 0);
+	VkQueueFamilyProperties* queprop = malloc(sizeof(VkQueueFamilyProperties) * quen);
+	vkGetPhysicalDeviceQueueFamilyProperties(cntx->gpu, &quen, queprop);
+	uint32_t bits = queprop[cntx->que_i].timestampValidBits;
+	free(queprop);
+	prof->mask = (bits >= 64) ? UINT64_MAX : ((uint64_t) 1 << bits) - 1;
+	
+	if (bits != 0) {
+		VkQueryPoolCreateInfo poolinfo;
+			poolinfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			poolinfo.pNext = 0;
+			poolinfo.flags = 0;
+			poolinfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			poolinfo.queryCount = cntx->frm_n * (scp_cap + 1) * 2;
+			poolinfo.pipelineStatistics = 0;
+		vkCreateQueryPool(cntx->devc, &poolinfo, 0, &(prof->pool));
+	}
+	
+	srfc->prof = prof;
+	return prof;
+}
+
+int32_t vlx_profile_scope(struct vlx_profile* prof, const char* name) {
+	for (uint32_t i = 0; i < prof->scp_n; i++) {
+		if (strcmp(prof->name[i], name) == 0) return i;
+	}
+	if (prof->scp_n == prof->scp_cap) return -1;
+	prof->name[prof->scp_n] = malloc(strlen(name) + 1);
+	strcpy(prof->name[prof->scp_n], name);
+	return prof->scp_n++;
+}
+
+void vlx_profile_begin(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, int32_t scp) {
+	struct vlx_profile* prof = srfc->prof;
+	if (prof == 0 || prof->pool == 0 || cmd->sec || cmd->cmp || scp < 0 || scp >= prof->scp_n) return;
+	uint32_t q = (srfc->frm_i * (prof->scp_cap + 1) + scp + 1) * 2;
+	vkCmdWriteTimestamp(cmd->draw[srfc->frm_i], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, prof->pool, q);
+}
+
+void vlx_profile_end(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, int32_t scp) {
+	struct vlx_profile* prof = srfc->prof;
+	if (prof == 0 || prof->pool == 0 || cmd->sec || cmd->cmp || scp < 0 || scp >= prof->scp_n) return;
+	uint32_t q = (srfc->frm_i * (prof->scp_cap + 1) + scp + 1) * 2;
+	vkCmdWriteTimestamp(cmd->draw[srfc->frm_i], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, prof->pool, q + 1);
+	prof->used[srfc->frm_i * (prof->scp_cap + 1) + scp + 1] = 1;
+}
+
+static void vlx_profile_trace(struct vlx_context* cntx, struct vlx_surface* srfc, uint64_t* ts, uint8_t* used) {
+	struct vlx_profile* prof = srfc->prof;
+	uint64_t gpu = ts[0];
+	uint64_t cpu = prof->t_sbmt[srfc->frm_i];
+	if (cntx->clbr != 0) {
+		VkCalibratedTimestampInfoEXT clbrinfo[2];
+			clbrinfo[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+			clbrinfo[0].pNext = 0;
+			clbrinfo[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+			clbrinfo[1] = clbrinfo[0];
+			clbrinfo[1].timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+		uint64_t now[2];
+		uint64_t dev;
+		if (cntx->clbr(cntx->devc, 2, clbrinfo, now, &dev) == VK_SUCCESS) {
+			gpu = now[0];
+			cpu = now[1];
+		}
+	}
+	
+	for (uint32_t i = 0; i < prof->scp_cap + 1; i++) {
+		if (!used[i]) continue;
+		int64_t d = (ts[i * 2] - gpu) & prof->mask;
+		if ((uint64_t) d > (prof->mask >> 1)) d -= (int64_t) prof->mask + 1;
+		uint64_t t0 = cpu + (int64_t) (d * prof->prd);
+		uint64_t dur = (double) ((ts[i * 2 + 1] - ts[i * 2]) & prof->mask) * prof->prd;
+		vlx_trace_event(cntx, (i == 0) ? "gpu frame" : prof->name[i - 1], 1, 0, t0, t0 + dur);
+	}
+}
+
+static void vlx_profile_frame(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd) {
+	struct vlx_profile* prof = srfc->prof;
+	if (prof->pool == 0) return;
+	
+	uint32_t n = prof->scp_cap + 1;
+	uint8_t* used = &(prof->used[srfc->frm_i * n]);
+	if (used[0]) {
+		uint64_t* ts = malloc(sizeof(uint64_t) * n * 2);
+		vkGetQueryPoolResults(cntx->devc, prof->pool, srfc->frm_i * n * 2, n * 2, sizeof(uint64_t) * n * 2, ts, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		for (uint32_t i = 0; i < n; i++) {
+			if (!used[i]) continue;
+			double ms = (double) ((ts[i * 2 + 1] - ts[i * 2]) & prof->mask) * prof->prd / 1000000.0;
+			vlx_ring_push(&(prof->ring[(i == 0) ? VLX_PROFILE_GPU : VLX_PROFILE_SCOPE + i - 1]), ms);
+		}
+		if (cntx->trce != 0) vlx_profile_trace(cntx, srfc, ts, used);
+		free(ts);
+	}
+	memset(used, 0, n);
+	
+	vkCmdResetQueryPool(cmd->draw[srfc->frm_i], prof->pool, srfc->frm_i * n * 2, n * 2);
+	vkCmdWriteTimestamp(cmd->draw[srfc->frm_i], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, prof->pool, srfc->frm_i * n * 2);
+}
+
+void vlx_profile_stats(struct vlx_profile* prof, uint32_t i, struct vlx_profile_stats* stat) {
+	memset(stat, 0, sizeof(struct vlx_profile_stats));
+	if (i >= VLX_PROFILE_SCOPE + prof->scp_n) return;
+	struct vlx_ring* ring = &(prof->ring[i]);
+	if (ring->n == 0) return;
+	
+	double* smpl = malloc(sizeof(double) * ring->n);
+	memcpy(smpl, ring->smpl, sizeof(double) * ring->n);
+	qsort(smpl, ring->n, sizeof(double), vlx_ring_cmp);
+	
+	double sum = 0.0;
+	for (uint32_t j = 0; j < ring->n; j++) sum += smpl[j];
+	stat->n = ring->n;
+	stat->last = ring->smpl[(ring->i + VLX_PROFILE_N - 1) % VLX_PROFILE_N];
+	stat->mean = sum / ring->n;
+	stat->p50 = smpl[(ring->n - 1) / 2];
+	stat->p99 = smpl[((ring->n - 1) * 99) / 100];
+	stat->max = smpl[ring->n - 1];
+	free(smpl);
+}
+
+struct vlx_query* vlx_query_create(struct vlx_context* cntx, struct vlx_surface* srfc, uint8_t type, uint32_t n) {
+	if (type == VLX_QUERY_STATISTICS && !cntx->feat.pipelineStatisticsQuery) return 0;
+	
+	struct vlx_query* qry = malloc(sizeof(struct vlx_query));
+	qry->srfc = srfc;
+	qry->n = n;
+	qry->type = (type == VLX_QUERY_STATISTICS) ? VK_QUERY_TYPE_PIPELINE_STATISTICS : VK_QUERY_TYPE_OCCLUSION;
+	qry->cnt = (type == VLX_QUERY_STATISTICS) ? VLX_QUERY_STATISTICS_N : 1;
+	qry->used = calloc(cntx->frm_n, sizeof(uint32_t));
+	qry->rslt = calloc(n * qry->cnt, sizeof(uint64_t));
+	qry->vld = calloc(n, sizeof(uint8_t));
+	
+	VkQueryPoolCreateInfo poolinfo;
+		poolinfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		poolinfo.pNext = 0;
+		poolinfo.flags = 0;
+		poolinfo.queryType = qry->type;
+		poolinfo.queryCount = cntx->frm_n * n;
+		poolinfo.pipelineStatistics = 0;
+	if (type == VLX_QUERY_STATISTICS) {
+		poolinfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT | VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+	}
+	vkCreateQueryPool(cntx->devc, &poolinfo, 0, &(qry->pool));
+	
+	qry->next = srfc->qry;
+	srfc->qry = qry;
+	return qry;
+}
+
+static void vlx_query_frame(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, struct vlx_query* qry) {
+	uint32_t used = qry->used[srfc->frm_i];
+	if (used != 0) {
+		vkGetQueryPoolResults(cntx->devc, qry->pool, srfc->frm_i * qry->n, used, sizeof(uint64_t) * qry->cnt * used, qry->rslt, sizeof(uint64_t) * qry->cnt, VK_QUERY_RESULT_64_BIT);
+		memset(qry->vld, 1, used);
+	}
+	memset(qry->vld + used, 0, qry->n - used);
+	qry->used[srfc->frm_i] = 0;
+	
+	vkCmdResetQueryPool(cmd->draw[srfc->frm_i], qry->pool, srfc->frm_i * qry->n, qry->n);
+}
+
+void vlx_surface_new_frame(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, uint8_t sec) {
+	uint64_t t0 = vlx_time();
+	vkWaitForFences(cntx->devc, 1, &(srfc->fnc[srfc->frm_i]), 1, UINT64_MAX);
+	vkResetFences(cntx->devc, 1, &(srfc->fnc[srfc->frm_i]));
+	cntx->frm_i = srfc->frm_i;
+	
+	uint64_t t1 = vlx_time();
+	if (srfc->off) srfc->img_i = srfc->frm_i;
+	else vkAcquireNextImageKHR(cntx->devc, srfc->swap, UINT64_MAX, srfc->smph_img[srfc->frm_i], 0, &(srfc->img_i));
+	uint64_t t2 = vlx_time();
 	
 	VkCommandBufferBeginInfo cbfrinfo;
 		cbfrinfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		cbfrinfo.pNext = 0;
 		cbfrinfo.flags = 0;
 		cbfrinfo.pInheritanceInfo = 0;
-	vkBeginCommandBuffer(cmd->draw, &cbfrinfo);
+	vkBeginCommandBuffer(cmd->draw[srfc->frm_i], &cbfrinfo);
+	memset(&(cmd->state), 0, sizeof(struct vlx_state));
+	
+	if (cntx->trce != 0) {
+		uint32_t tid = syscall(SYS_gettid);
+		vlx_trace_event(cntx, "frame fence wait", 0, tid, t0, t1);
+		vlx_trace_event(cntx, "vkAcquireNextImageKHR", 0, tid, t1, t2);
+	}
+	if (srfc->prof != 0) {
+		vlx_ring_push(&(srfc->prof->ring[VLX_PROFILE_WAIT]), (t1 - t0) / 1000000.0);
+		vlx_ring_push(&(srfc->prof->ring[VLX_PROFILE_ACQUIRE]), (t2 - t1) / 1000000.0);
+		vlx_profile_frame(cntx, srfc, cmd);
+		srfc->prof->t_rec = vlx_time();
+	}
+	for (struct vlx_query* qry = srfc->qry; qry != 0; qry = qry->next) {
+		vlx_query_frame(cntx, srfc, cmd, qry);
+	}
 	
 	VkImageMemoryBarrier imgmembar;
 		imgmembar.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -1007,7 +3078,14 @@ void vlx_surface_new_frame(struct vlx_context* cntx, struct vlx_surface* srfc, s
 		imgmembar.subresourceRange.levelCount = 1;
 		imgmembar.subresourceRange.baseArrayLayer = 0;
 		imgmembar.subresourceRange.layerCount = 1;
-	vkCmdPipelineBarrier(cmd->draw, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, 0, 0, 0, 1, &imgmembar);
+	vkCmdPipelineBarrier(cmd->draw[srfc->frm_i], VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, 0, 0, 0, 1, &imgmembar);
+	
+	cmd->rndr = 0;
+	cmd->cnts = sec;
+}
+
+static void vlx_surface_pass(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd) {
+	if (cmd->sec || cmd->rndr) return;
 	
 	VkRenderPassBeginInfo rndrinfo;
 		rndrinfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -1020,38 +3098,535 @@ void vlx_surface_new_frame(struct vlx_context* cntx, struct vlx_surface* srfc, s
 		rndrinfo.renderArea.extent.height = srfc->h;
 		rndrinfo.clearValueCount = 2;
 		rndrinfo.pClearValues = srfc->clr;
-	vkCmdBeginRenderPass(cmd->draw, &rndrinfo, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdBeginRenderPass(cmd->draw[srfc->frm_i], &rndrinfo, cmd->cnts ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+	cmd->rndr = 1;
+}
+
+int32_t vlx_query_begin(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, struct vlx_query* qry) {
+	if (cmd->sec || cmd->cmp || cmd->cnts || qry->used[srfc->frm_i] == qry->n) return -1;
+	vlx_surface_pass(cntx, srfc, cmd);
+	
+	uint32_t i = qry->used[srfc->frm_i]++;
+	VkQueryControlFlags flag = 0;
+	if (qry->type == VK_QUERY_TYPE_OCCLUSION && cntx->feat.occlusionQueryPrecise) flag = VK_QUERY_CONTROL_PRECISE_BIT;
+	vkCmdBeginQuery(cmd->draw[srfc->frm_i], qry->pool, srfc->frm_i * qry->n + i, flag);
+	return i;
+}
+
+void vlx_query_end(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, struct vlx_query* qry, int32_t i) {
+	if (i < 0 || cmd->sec || cmd->cmp || cmd->cnts) return;
+	vkCmdEndQuery(cmd->draw[srfc->frm_i], qry->pool, srfc->frm_i * qry->n + i);
+}
+
+int8_t vlx_query_result(struct vlx_query* qry, uint32_t i, uint64_t* data) {
+	if (i >= qry->n || !qry->vld[i]) return 0;
+	memcpy(data, &(qry->rslt[i * qry->cnt]), sizeof(uint64_t) * qry->cnt);
+	return 1;
+}
+
+void vlx_command_begin(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd) {
+	VkCommandBufferInheritanceInfo inhrinfo;
+		inhrinfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inhrinfo.pNext = 0;
+		inhrinfo.renderPass = srfc->rndr;
+		inhrinfo.subpass = 0;
+		inhrinfo.framebuffer = srfc->frme[srfc->img_i];
+		inhrinfo.occlusionQueryEnable = 0;
+		inhrinfo.queryFlags = 0;
+		inhrinfo.pipelineStatistics = 0;
+	
+	VkCommandBufferBeginInfo cbfrinfo;
+		cbfrinfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		cbfrinfo.pNext = 0;
+		cbfrinfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		cbfrinfo.pInheritanceInfo = &inhrinfo;
+	vkBeginCommandBuffer(cmd->draw[srfc->frm_i], &cbfrinfo);
+	memset(&(cmd->state), 0, sizeof(struct vlx_state));
+}
+
+void vlx_command_end(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd) {
+	vkEndCommandBuffer(cmd->draw[srfc->frm_i]);
+}
+
+void vlx_surface_execute_frame(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, struct vlx_command** sec, uint32_t n) {
+	VkCommandBuffer draw[n];
+	for (uint32_t i = 0; i < n; i++) {
+		draw[i] = sec[i]->draw[srfc->frm_i];
+	}
+	vlx_surface_pass(cntx, srfc, cmd);
+	vkCmdExecuteCommands(cmd->draw[srfc->frm_i], n, draw);
+}
+
+static uint32_t vlx_descriptor_offsets(struct vlx_context* cntx, struct vlx_descriptor* dscr, uint32_t* off) {
+	uint32_t n = 0;
+	for (uint32_t i = 0; i < dscr->n; i++) {
+		for (uint32_t j = 0; j < dscr->t; j++) {
+			if (dscr->type[j] != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) continue;
+			struct vlx_buffer* bfr = dscr->bind[i * dscr->t + j];
+			off[n++] = (bfr != 0) ? vlx_buffer_region(cntx, bfr) : 0;
+		}
+	}
+	return n;
+}
+
+static void vlx_surface_bind(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_pipeline* pipe, struct vlx_command* cmd, struct vlx_buffer* indx, struct vlx_vertex* vrtx, struct vlx_descriptor* dscr, void* push, uint64_t push_sz) {
+	VkCommandBuffer draw = cmd->draw[srfc->frm_i];
+	struct vlx_state* st = &(cmd->state);
+	vlx_surface_pass(cntx, srfc, cmd);
+	
+	if (st->pipe != pipe->pipe) {
+		vkCmdBindPipeline(draw, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->pipe);
+		st->pipe = pipe->pipe;
+		st->emit++;
+	}
+	else st->skip++;
+	
+	if (st->layt != pipe->layt) {
+		st->layt = pipe->layt;
+		st->dscr = 0;
+		st->push_sz = 0;
+	}
+	
+	if (st->w != srfc->w || st->h != srfc->h) {
+		VkViewport vprt;
+			vprt.x = 0.f;
+			vprt.y = 0.f;
+			vprt.width = (float) srfc->w;
+			vprt.height = (float) srfc->h;
+			vprt.minDepth = 0.f;
+			vprt.maxDepth = 1.f;
+		vkCmdSetViewport(draw, 0, 1, &vprt);
+		
+		VkRect2D scsr;
+			scsr.offset.x = 0;
+			scsr.offset.y = 0;
+			scsr.extent.width = srfc->w;
+			scsr.extent.height = srfc->h;
+		vkCmdSetScissor(draw, 0, 1, &scsr);
+		
+		st->w = srfc->w;
+		st->h = srfc->h;
+		st->emit += 2;
+	}
+	else st->skip += 2;
+	
+	VkBuffer bfr[vrtx->b];
+	VkDeviceSize off[vrtx->b];
+	uint8_t same = vrtx->b == st->vrtx_n;
+	for (uint32_t i = 0; i < vrtx->b; i++) {
+		bfr[i] = vrtx->bfr[i].bfr;
+		off[i] = vlx_buffer_region(cntx, &(vrtx->bfr[i]));
+		if (same && (bfr[i] != st->vrtx[i] || off[i] != st->vrtx_off[i])) same = 0;
+	}
+	if (!same) {
+		vkCmdBindVertexBuffers(draw, 0, vrtx->b, bfr, off);
+		st->vrtx_n = 0;
+		if (vrtx->b <= VLX_STATE_BINDINGS) {
+			memcpy(st->vrtx, bfr, sizeof(VkBuffer) * vrtx->b);
+			memcpy(st->vrtx_off, off, sizeof(VkDeviceSize) * vrtx->b);
+			st->vrtx_n = vrtx->b;
+		}
+		st->emit++;
+	}
+	else st->skip++;
+	
+	VkDeviceSize indx_rgn = vlx_buffer_region(cntx, indx);
+	if (st->indx != indx->bfr || st->indx_off != indx_rgn) {
+		vkCmdBindIndexBuffer(draw, indx->bfr, indx_rgn, VK_INDEX_TYPE_UINT32);
+		st->indx = indx->bfr;
+		st->indx_off = indx_rgn;
+		st->emit++;
+	}
+	else st->skip++;
+	
+	if (dscr != 0 && st->dscr != dscr) {
+		uint32_t dyn[dscr->n * dscr->t];
+		uint32_t dyn_n = vlx_descriptor_offsets(cntx, dscr, dyn);
+		vkCmdBindDescriptorSets(draw, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layt, 0, dscr->n, dscr->set, dyn_n, dyn);
+		st->dscr = dscr;
+		st->emit++;
+	}
+	else if (dscr != 0) st->skip++;
+	
+	if (push_sz != 0 && (push_sz != st->push_sz || memcmp(st->push, push, push_sz) != 0)) {
+		vkCmdPushConstants(draw, pipe->layt, pipe->stg, 0, push_sz, push);
+		st->push_sz = 0;
+		if (push_sz <= VLX_STATE_PUSH) {
+			memcpy(st->push, push, push_sz);
+			st->push_sz = push_sz;
+		}
+		st->emit++;
+	}
+	else if (push_sz != 0) st->skip++;
 }
 
 void vlx_surface_draw_frame(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_pipeline* pipe, struct vlx_command* cmd, struct vlx_buffer* indx, struct vlx_vertex* vrtx, struct vlx_descriptor* dscr, void* push, uint64_t push_sz, uint32_t n, uint32_t indx_off, uint32_t vrtx_off) {
-	vkCmdBindPipeline(cmd->draw, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->pipe);
+	vlx_surface_bind(cntx, srfc, pipe, cmd, indx, vrtx, dscr, push, push_sz);
+	vkCmdDrawIndexed(cmd->draw[srfc->frm_i], n, 1, indx_off, vrtx_off, 0);
+}
+
+void vlx_surface_draw_instanced(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_pipeline* pipe, struct vlx_command* cmd, struct vlx_buffer* indx, struct vlx_vertex* vrtx, struct vlx_descriptor* dscr, void* push, uint64_t push_sz, uint32_t n, uint32_t indx_off, uint32_t vrtx_off, uint32_t inst_n, uint32_t inst_i) {
+	vlx_surface_bind(cntx, srfc, pipe, cmd, indx, vrtx, dscr, push, push_sz);
+	vkCmdDrawIndexed(cmd->draw[srfc->frm_i], n, inst_n, indx_off, vrtx_off, inst_i);
+}
+
+void vlx_surface_draw_indirect(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_pipeline* pipe, struct vlx_command* cmd, struct vlx_buffer* indx, struct vlx_vertex* vrtx, struct vlx_descriptor* dscr, void* push, uint64_t push_sz, struct vlx_buffer* drw, uint64_t drw_off, uint32_t n, struct vlx_buffer* cnt, uint64_t cnt_off) {
+	VkCommandBuffer draw = cmd->draw[srfc->frm_i];
+	vlx_surface_bind(cntx, srfc, pipe, cmd, indx, vrtx, dscr, push, push_sz);
+	
+	uint32_t strd = sizeof(VkDrawIndexedIndirectCommand);
+	VkDeviceSize off = vlx_buffer_region(cntx, drw) + drw_off;
+	if (cnt != 0 && cntx->draw_cnt != 0) cntx->draw_cnt(draw, drw->bfr, off, cnt->bfr, vlx_buffer_region(cntx, cnt) + cnt_off, n, strd);
+	else if (cntx->feat.multiDrawIndirect) vkCmdDrawIndexedIndirect(draw, drw->bfr, off, n, strd);
+	else {
+		for (uint32_t i = 0; i < n; i++) {
+			vkCmdDrawIndexedIndirect(draw, drw->bfr, off + (VkDeviceSize) i * strd, 1, strd);
+		}
+	}
+}
+
+static void vlx_compute_bind(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, struct vlx_pipeline* pipe, struct vlx_descriptor* dscr, void* push, uint64_t push_sz) {
+	VkCommandBuffer draw = cmd->draw[srfc->frm_i];
+	VkPipelineStageFlags stg = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	if (!cmd->cmp) stg |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	
+	VkMemoryBarrier membar;
+		membar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		membar.pNext = 0;
+		membar.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		membar.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	vkCmdPipelineBarrier(draw, stg, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &membar, 0, 0, 0, 0);
+	
+	vkCmdBindPipeline(draw, VK_PIPELINE_BIND_POINT_COMPUTE, pipe->pipe);
+	if (dscr != 0) {
+		uint32_t dyn[dscr->n * dscr->t];
+		uint32_t dyn_n = vlx_descriptor_offsets(cntx, dscr, dyn);
+		vkCmdBindDescriptorSets(draw, VK_PIPELINE_BIND_POINT_COMPUTE, pipe->layt, 0, dscr->n, dscr->set, dyn_n, dyn);
+	}
+	if (push_sz != 0) vkCmdPushConstants(draw, pipe->layt, pipe->stg, 0, push_sz, push);
 	
-	VkViewport vprt;
-		vprt.x = 0.f;
-		vprt.y = 0.f;
-		vprt.width = (float) srfc->w;
-		vprt.height = (float) srfc->h;
-		vprt.minDepth = 0.f;
-		vprt.maxDepth = 1.f;
-	vkCmdSetViewport(cmd->draw, 0, 1, &vprt);
+	cmd->state.layt = 0;
+	cmd->state.dscr = 0;
+	cmd->state.push_sz = 0;
+}
+
+static void vlx_compute_done(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd) {
+	if (cmd->cmp) return;
+	
+	VkMemoryBarrier membar;
+		membar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		membar.pNext = 0;
+		membar.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		membar.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(cmd->draw[srfc->frm_i], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &membar, 0, 0, 0, 0);
+}
+
+int8_t vlx_compute_dispatch(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, struct vlx_pipeline* pipe, struct vlx_descriptor* dscr, void* push, uint64_t push_sz, uint32_t x, uint32_t y, uint32_t z) {
+	if (cmd->sec || cmd->rndr) return 0;
+	vlx_compute_bind(cntx, srfc, cmd, pipe, dscr, push, push_sz);
+	vkCmdDispatch(cmd->draw[srfc->frm_i], x, y, z);
+	vlx_compute_done(cntx, srfc, cmd);
+	return 1;
+}
+
+int8_t vlx_compute_dispatch_indirect(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, struct vlx_pipeline* pipe, struct vlx_descriptor* dscr, void* push, uint64_t push_sz, struct vlx_buffer* arg, uint64_t arg_off) {
+	if (cmd->sec || cmd->rndr) return 0;
+	vlx_compute_bind(cntx, srfc, cmd, pipe, dscr, push, push_sz);
+	vkCmdDispatchIndirect(cmd->draw[srfc->frm_i], arg->bfr, vlx_buffer_region(cntx, arg) + arg_off);
+	vlx_compute_done(cntx, srfc, cmd);
+	return 1;
+}
+
+struct vlx_cull* vlx_cull_create(struct vlx_context* cntx, struct vlx_shader* shdc, uint32_t n, uint8_t mode) {
+	if (!cntx->feat.drawIndirectFirstInstance) return 0;
+	struct vlx_cull* cull = malloc(sizeof(struct vlx_cull));
+	cull->n = n;
+	cull->act = 0;
+	cull->cmpt = cntx->draw_cnt != 0;
+	
+	uint64_t drw_sz = ((uint64_t) n * sizeof(VkDrawIndexedIndirectCommand) + VLX_REGION_ALIGN - 1) & ~((uint64_t) VLX_REGION_ALIGN - 1);
+	uint64_t cnt_sz = VLX_REGION_ALIGN;
+	int8_t ok[3];
+	ok[0] = vlx_buffer_init(cntx, &(cull->obj), (uint64_t) n * sizeof(struct vlx_cull_object), mode, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+	ok[1] = vlx_buffer_init(cntx, &(cull->drw), drw_sz * cntx->frm_n, VLX_BUFFER_STATIC, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+	ok[2] = vlx_buffer_init(cntx, &(cull->cnt), cnt_sz * cntx->frm_n, VLX_BUFFER_STATIC, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+	cull->dmmy = (ok[0] && ok[1] && ok[2]) ? vlx_texture_storage(cntx, 1, 1, VLX_FORMAT_R32F) : 0;
+	if (cull->dmmy == 0) {
+		if (ok[0]) vlx_buffer_deinit(cntx, &(cull->obj));
+		if (ok[1]) vlx_buffer_deinit(cntx, &(cull->drw));
+		if (ok[2]) vlx_buffer_deinit(cntx, &(cull->cnt));
+		free(cull);
+		return 0;
+	}
+	cull->drw.sz = drw_sz;
+	cull->drw.rng_n = cntx->frm_n;
+	cull->cnt.sz = cnt_sz;
+	cull->cnt.rng_n = cntx->frm_n;
+	cull->hiz = 0;
+	
+	uint8_t type[4] = {VLX_DESCRIPTOR_STORAGE_BUFFER, VLX_DESCRIPTOR_STORAGE_BUFFER, VLX_DESCRIPTOR_STORAGE_BUFFER, VLX_DESCRIPTOR_TEXTURE};
+	cull->tmpl = vlx_descriptor_layout(cntx, 1, type, 4);
+	cull->dscr = vlx_descriptor_layout(cntx, cntx->frm_n, type, 4);
+	for (uint32_t i = 0; i < cntx->frm_n; i++) {
+		vlx_descriptor_buffer(cntx, cull->dscr, i, 0, &(cull->obj), 0, 0);
+		vlx_descriptor_buffer(cntx, cull->dscr, i, 1, &(cull->drw), i * drw_sz, drw_sz);
+		vlx_descriptor_buffer(cntx, cull->dscr, i, 2, &(cull->cnt), i * cnt_sz, sizeof(uint32_t));
+		vlx_descriptor_image(cntx, cull->dscr, i, 3, cull->dmmy);
+	}
+	cull->pipe = vlx_pipeline_compute(cntx, shdc, cull->tmpl, sizeof(struct vlx_cull_push));
 	
-	VkRect2D scsr;
-		scsr.offset.x = 0;
-		scsr.offset.y = 0;
-		scsr.extent.width = srfc->w;
-		scsr.extent.height = srfc->h;
-	vkCmdSetScissor(cmd->draw, 0, 1, &scsr);
+	return cull;
+}
+
+void vlx_cull_refresh(struct vlx_context* cntx, struct vlx_cull* cull, const struct vlx_cull_object* obj, uint32_t n, uint32_t i) {
+	vlx_buffer_refresh(cntx, &(cull->obj), (void*) obj, (uint64_t) n * sizeof(struct vlx_cull_object), (uint64_t) i * sizeof(struct vlx_cull_object));
+}
+
+int8_t vlx_cull_dispatch(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, struct vlx_cull* cull, const float* mvp, uint32_t n) {
+	if (cmd->sec || cmd->rndr) {
+		cull->act = 0;
+		return 0;
+	}
+	VkCommandBuffer draw = cmd->draw[srfc->frm_i];
+	if (n > cull->n) n = cull->n;
+	cull->act = n;
+	
+	struct vlx_cull_push push;
+	memcpy(push.mvp, mvp, sizeof(push.mvp));
+	push.size[0] = 0.f;
+	push.size[1] = 0.f;
+	push.lvl = 0;
+	if (cull->hiz != 0 && cull->hiz_gen != cull->hiz->gen) vlx_cull_occlusion(cntx, cull, cull->hiz);
+	if (cull->hiz != 0 && cull->hiz->ok) {
+		push.size[0] = cull->hiz->w;
+		push.size[1] = cull->hiz->h;
+		push.lvl = cull->hiz->lvl;
+	}
+	push.n = n;
+	push.cmpt = cull->cmpt;
+	
+	vkCmdPipelineBarrier(draw, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, 0, 0, 0, 0, 0);
+	vkCmdFillBuffer(draw, cull->cnt.bfr, vlx_buffer_region(cntx, &(cull->cnt)), sizeof(uint32_t), 0);
+	
+	VkMemoryBarrier membar;
+		membar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		membar.pNext = 0;
+		membar.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		membar.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(draw, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &membar, 0, 0, 0, 0);
+	
+	vlx_compute_bind(cntx, srfc, cmd, cull->pipe, 0, &push, sizeof(struct vlx_cull_push));
+	vkCmdBindDescriptorSets(draw, VK_PIPELINE_BIND_POINT_COMPUTE, cull->pipe->layt, 0, 1, &(cull->dscr->set[cntx->frm_i]), 0, 0);
+	vkCmdDispatch(draw, (n + 63) / 64, 1, 1);
+	vlx_compute_done(cntx, srfc, cmd);
+	return 1;
+}
+
+static int8_t vlx_hiz_init(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_hiz* hiz) {
+	hiz->w = srfc->w;
+	hiz->h = srfc->h;
+	hiz->lvl = vlx_log2(((hiz->w > hiz->h) ? hiz->w : hiz->h) + 1);
+	hiz->dpth = 0;
+	hiz->ok = 0;
+	
+	hiz->txtr = vlx_texture_init(cntx, &(cntx->upld), VK_FORMAT_R32_SFLOAT, hiz->w, hiz->h, hiz->lvl, VK_IMAGE_USAGE_STORAGE_BIT);
+	if (hiz->txtr == 0) return 0;
+	hiz->txtr->lay = VK_IMAGE_LAYOUT_GENERAL;
+	vlx_upload_layout(cntx, hiz->txtr->xfr, hiz->txtr->img.img, hiz->txtr->lay);
+	hiz->txtr->id = hiz->txtr->xfr->sbmt + 1;
+	
+	hiz->mip = malloc(sizeof(VkImageView) * hiz->lvl);
+	VkImageViewCreateInfo imgvinfo;
+		imgvinfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		imgvinfo.pNext = 0;
+		imgvinfo.flags = 0;
+		imgvinfo.image = hiz->txtr->img.img;
+		imgvinfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		imgvinfo.format = VK_FORMAT_R32_SFLOAT;
+		imgvinfo.components.r = 0;
+		imgvinfo.components.g = 0;
+		imgvinfo.components.b = 0;
+		imgvinfo.components.a = 0;
+		imgvinfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		imgvinfo.subresourceRange.levelCount = 1;
+		imgvinfo.subresourceRange.baseArrayLayer = 0;
+		imgvinfo.subresourceRange.layerCount = 1;
+	for (uint32_t i = 0; i < hiz->lvl; i++) {
+			imgvinfo.subresourceRange.baseMipLevel = i;
+		vkCreateImageView(cntx->devc, &imgvinfo, 0, &(hiz->mip[i]));
+	}
+	
+	uint8_t type[2] = {VLX_DESCRIPTOR_TEXTURE, VLX_DESCRIPTOR_STORAGE_IMAGE};
+	hiz->dscr = vlx_descriptor_layout(cntx, hiz->lvl, type, 2);
+	
+	VkDescriptorImageInfo img[2];
+		img[0].sampler = hiz->txtr->smpl;
+		img[1].sampler = 0;
+		img[1].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+	VkWriteDescriptorSet writ[2];
+	for (uint32_t j = 0; j < 2; j++) {
+			writ[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writ[j].pNext = 0;
+			writ[j].dstBinding = j;
+			writ[j].dstArrayElement = 0;
+			writ[j].descriptorCount = 1;
+			writ[j].descriptorType = hiz->dscr->type[j];
+			writ[j].pImageInfo = &(img[j]);
+			writ[j].pBufferInfo = 0;
+			writ[j].pTexelBufferView = 0;
+	}
+	for (uint32_t i = 0; i < hiz->lvl; i++) {
+			img[0].imageView = (i == 0) ? srfc->dpth.v : hiz->mip[i - 1];
+			img[0].imageLayout = (i == 0) ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+			img[1].imageView = hiz->mip[i];
+			writ[0].dstSet = hiz->dscr->set[i];
+			writ[1].dstSet = hiz->dscr->set[i];
+		vkUpdateDescriptorSets(cntx->devc, 2, writ, 0, 0);
+	}
+	
+	return 1;
+}
+
+static void vlx_hiz_release(struct vlx_context* cntx, struct vlx_hiz* hiz) {
+	if (hiz->txtr == 0) return;
+	vlx_descriptor_destroy(cntx, hiz->dscr);
+	for (uint32_t i = 0; i < hiz->lvl; i++) {
+		vkDestroyImageView(cntx->devc, hiz->mip[i], 0);
+	}
+	free(hiz->mip);
+	vlx_texture_destroy(cntx, hiz->txtr);
+	hiz->txtr = 0;
+}
+
+static void vlx_surface_rebuild_hiz(struct vlx_context* cntx, struct vlx_surface* srfc) {
+	for (struct vlx_hiz* hiz = srfc->hiz; hiz != 0; hiz = hiz->next) {
+		vlx_hiz_release(cntx, hiz);
+		hiz->gen++;
+		if (srfc->dpth.mem.blck != 0) vlx_hiz_init(cntx, srfc, hiz);
+	}
+}
+
+struct vlx_hiz* vlx_hiz_create(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_shader* shdh) {
+	struct vlx_hiz* hiz = malloc(sizeof(struct vlx_hiz));
+	hiz->gen = 0;
+	hiz->txtr = 0;
+	if (!vlx_hiz_init(cntx, srfc, hiz)) {
+		free(hiz);
+		return 0;
+	}
+	
+	uint8_t type[2] = {VLX_DESCRIPTOR_TEXTURE, VLX_DESCRIPTOR_STORAGE_IMAGE};
+	hiz->tmpl = vlx_descriptor_layout(cntx, 1, type, 2);
+	hiz->pipe = vlx_pipeline_compute(cntx, shdh, hiz->tmpl, 0);
+	
+	hiz->srfc = srfc;
+	hiz->next = srfc->hiz;
+	srfc->hiz = hiz;
+	return hiz;
+}
+
+int8_t vlx_hiz_build(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd, struct vlx_hiz* hiz) {
+	if (cmd->sec || cmd->cmp || cmd->rndr || hiz->txtr == 0) return 0;
+	if (!hiz->dpth) {
+		hiz->dpth = 1;
+		return 1;
+	}
+	VkCommandBuffer draw = cmd->draw[srfc->frm_i];
+	
+	VkImageMemoryBarrier imgmembar;
+		imgmembar.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imgmembar.pNext = 0;
+		imgmembar.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		imgmembar.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		imgmembar.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		imgmembar.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imgmembar.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imgmembar.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imgmembar.image = srfc->dpth.img;
+		imgmembar.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		imgmembar.subresourceRange.baseMipLevel = 0;
+		imgmembar.subresourceRange.levelCount = 1;
+		imgmembar.subresourceRange.baseArrayLayer = 0;
+		imgmembar.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(draw, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, 0, 0, 0, 1, &imgmembar);
+	
+	for (uint32_t i = 0; i < hiz->lvl; i++) {
+		uint32_t mw = (hiz->w >> i) ? (hiz->w >> i) : 1;
+		uint32_t mh = (hiz->h >> i) ? (hiz->h >> i) : 1;
+		vlx_compute_bind(cntx, srfc, cmd, hiz->pipe, 0, 0, 0);
+		vkCmdBindDescriptorSets(draw, VK_PIPELINE_BIND_POINT_COMPUTE, hiz->pipe->layt, 0, 1, &(hiz->dscr->set[i]), 0, 0);
+		vkCmdDispatch(draw, (mw + 7) / 8, (mh + 7) / 8, 1);
+	}
+	vlx_compute_done(cntx, srfc, cmd);
+	
+		imgmembar.srcAccessMask = 0;
+		imgmembar.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		imgmembar.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imgmembar.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	vkCmdPipelineBarrier(draw, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, 0, 0, 0, 0, 0, 1, &imgmembar);
+	
+	hiz->ok = 1;
+	return 1;
+}
+
+void vlx_cull_occlusion(struct vlx_context* cntx, struct vlx_cull* cull, struct vlx_hiz* hiz) {
+	cull->hiz = hiz;
+	cull->hiz_gen = (hiz != 0) ? hiz->gen : 0;
+	for (uint32_t i = 0; i < cntx->frm_n; i++) {
+		vlx_descriptor_image(cntx, cull->dscr, i, 3, (hiz != 0 && hiz->txtr != 0) ? hiz->txtr : cull->dmmy);
+	}
+}
+
+void vlx_surface_draw_culled(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_pipeline* pipe, struct vlx_command* cmd, struct vlx_buffer* indx, struct vlx_vertex* vrtx, struct vlx_descriptor* dscr, void* push, uint64_t push_sz, struct vlx_cull* cull) {
+	if (cull->act == 0) return;
+	vlx_surface_draw_indirect(cntx, srfc, pipe, cmd, indx, vrtx, dscr, push, push_sz, &(cull->drw), 0, cull->act, &(cull->cnt), 0);
+}
+
+void vlx_compute_begin(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd) {
+	if (!cmd->cmp) return;
+	
+	VkCommandBufferBeginInfo cbfrinfo;
+		cbfrinfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		cbfrinfo.pNext = 0;
+		cbfrinfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		cbfrinfo.pInheritanceInfo = 0;
+	vkBeginCommandBuffer(cmd->draw[srfc->frm_i], &cbfrinfo);
+	memset(&(cmd->state), 0, sizeof(struct vlx_state));
+	cmd->rndr = 0;
+	srfc->acmp = 1;
+}
+
+void vlx_compute_submit(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd) {
+	if (!cmd->cmp) return;
+	vkEndCommandBuffer(cmd->draw[srfc->frm_i]);
 	
-	VkDeviceSize offset = {0};
-	vkCmdBindVertexBuffers(cmd->draw, 0, vrtx->b, vrtx->bfr, &offset);
-	vkCmdBindIndexBuffer(cmd->draw, indx->bfr, 0, VK_INDEX_TYPE_UINT32);
-	if (dscr != 0) vkCmdBindDescriptorSets(cmd->draw, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layt, 0, dscr->n, dscr->set, 0, 0);
-	vkCmdPushConstants(cmd->draw, pipe->layt, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, push_sz, push);
-	vkCmdDrawIndexed(cmd->draw, n, 1, indx_off, vrtx_off, 0);
+	uint32_t prev = (srfc->frm_i + cntx->frm_n - 1) % cntx->frm_n;
+	VkPipelineStageFlags pipeflag = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	VkSubmitInfo sbmtinfo;
+		sbmtinfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		sbmtinfo.pNext = 0;
+		sbmtinfo.waitSemaphoreCount = srfc->gfx[prev];
+		sbmtinfo.pWaitSemaphores = &(srfc->smph_gfx[prev]);
+		sbmtinfo.pWaitDstStageMask = &pipeflag;
+		sbmtinfo.commandBufferCount = 1;
+		sbmtinfo.pCommandBuffers = &(cmd->draw[srfc->frm_i]);
+		sbmtinfo.signalSemaphoreCount = 1;
+		sbmtinfo.pSignalSemaphores = &(srfc->smph_cmp[srfc->frm_i]);
+	vkQueueSubmit(cntx->cmp, 1, &sbmtinfo, 0);
+	srfc->gfx[prev] = 0;
+	srfc->cmp = 1;
+}
+
+void vlx_command_stats(struct vlx_command* cmd, uint64_t* emit, uint64_t* skip) {
+	*emit = cmd->state.emit;
+	*skip = cmd->state.skip;
 }
 
 void vlx_surface_swap_frame(struct vlx_context* cntx, struct vlx_surface* srfc, struct vlx_command* cmd) {
-	vkCmdEndRenderPass(cmd->draw);
+	struct vlx_profile* prof = srfc->prof;
+	uint64_t t0 = vlx_time();
+	vlx_surface_pass(cntx, srfc, cmd);
+	vkCmdEndRenderPass(cmd->draw[srfc->frm_i]);
 	
 	VkImageMemoryBarrier imgmembar;
 		imgmembar.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -1060,6 +3635,11 @@ void vlx_surface_swap_frame(struct vlx_context* cntx, struct vlx_surface* srfc,
 		imgmembar.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
 		imgmembar.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		imgmembar.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	if (srfc->off) {
+		imgmembar.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		imgmembar.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		imgmembar.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	}
 		imgmembar.srcQueueFamilyIndex = cntx->que_i;
 		imgmembar.dstQueueFamilyIndex = cntx->que_i;
 		imgmembar.image = srfc->swap_img[srfc->img_i];
@@ -1068,98 +3648,237 @@ void vlx_surface_swap_frame(struct vlx_context* cntx, struct vlx_surface* srfc,
 		imgmembar.subresourceRange.levelCount = 1;
 		imgmembar.subresourceRange.baseArrayLayer = 0;
 		imgmembar.subresourceRange.layerCount = 1;
-	vkCmdPipelineBarrier(cmd->draw, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, 0, 0, 0, 1, &imgmembar);
+	vkCmdPipelineBarrier(cmd->draw[srfc->frm_i], VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, srfc->off ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, 0, 0, 0, 1, &imgmembar);
+	
+	if (srfc->off) {
+		VkBufferImageCopy cp;
+			cp.bufferOffset = srfc->frm_i * srfc->rdbk.sz;
+			cp.bufferRowLength = 0;
+			cp.bufferImageHeight = 0;
+			cp.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			cp.imageSubresource.mipLevel = 0;
+			cp.imageSubresource.baseArrayLayer = 0;
+			cp.imageSubresource.layerCount = 1;
+			cp.imageOffset.x = 0;
+			cp.imageOffset.y = 0;
+			cp.imageOffset.z = 0;
+			cp.imageExtent.width = srfc->w;
+			cp.imageExtent.height = srfc->h;
+			cp.imageExtent.depth = 1;
+		vkCmdCopyImageToBuffer(cmd->draw[srfc->frm_i], srfc->swap_img[srfc->img_i], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, srfc->rdbk.bfr, 1, &cp);
+		
+		VkMemoryBarrier membar;
+			membar.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			membar.pNext = 0;
+			membar.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			membar.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(cmd->draw[srfc->frm_i], VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &membar, 0, 0, 0, 0);
+	}
+	
+	if (prof != 0 && prof->pool != 0) {
+		uint32_t n = prof->scp_cap + 1;
+		vkCmdWriteTimestamp(cmd->draw[srfc->frm_i], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, prof->pool, srfc->frm_i * n * 2 + 1);
+		prof->used[srfc->frm_i * n] = 1;
+	}
+	
+	vkEndCommandBuffer(cmd->draw[srfc->frm_i]);
 	
-	vkEndCommandBuffer(cmd->draw);
+	vlx_upload_flush(cntx);
 
-	VkPipelineStageFlags pipeflag = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	VkSemaphore wait[3];
+	VkPipelineStageFlags pipeflag[3];
+	uint32_t waitn = 0;
+	if (!srfc->off) {
+		wait[waitn] = srfc->smph_img[srfc->frm_i];
+		pipeflag[waitn++] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	}
+	if (srfc->cmp) {
+		wait[waitn] = srfc->smph_cmp[srfc->frm_i];
+		pipeflag[waitn++] = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	}
+	if (srfc->gfx[srfc->frm_i]) {
+		wait[waitn] = srfc->smph_gfx[srfc->frm_i];
+		pipeflag[waitn++] = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+	}
+	VkSemaphore sgnl[2];
+	uint32_t sgnln = 0;
+	if (!srfc->off) sgnl[sgnln++] = srfc->smph_drw[srfc->frm_i];
+	if (srfc->acmp) sgnl[sgnln++] = srfc->smph_gfx[srfc->frm_i];
 	VkSubmitInfo sbmtinfo;
 		sbmtinfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 		sbmtinfo.pNext = 0;
-		sbmtinfo.waitSemaphoreCount = 1;
-		sbmtinfo.pWaitSemaphores = &cntx->smph_img;
-		sbmtinfo.pWaitDstStageMask = &pipeflag;
+		sbmtinfo.waitSemaphoreCount = waitn;
+		sbmtinfo.pWaitSemaphores = wait;
+		sbmtinfo.pWaitDstStageMask = pipeflag;
 		sbmtinfo.commandBufferCount = 1;
-		sbmtinfo.pCommandBuffers = &(cmd->draw);
-		sbmtinfo.signalSemaphoreCount = 1;
-		sbmtinfo.pSignalSemaphores = &cntx->smph_drw;
-	vkQueueSubmit(cntx->que, 1, &sbmtinfo, cntx->fnc);
+		sbmtinfo.pCommandBuffers = &(cmd->draw[srfc->frm_i]);
+		sbmtinfo.signalSemaphoreCount = sgnln;
+		sbmtinfo.pSignalSemaphores = sgnl;
+	vkQueueSubmit(cntx->que, 1, &sbmtinfo, srfc->fnc[srfc->frm_i]);
+	srfc->gfx[srfc->frm_i] = srfc->acmp;
+	srfc->cmp = 0;
+	uint64_t t2 = vlx_time();
+	
+	if (srfc->off) {
+		if (srfc->rdbk_n < cntx->frm_n) srfc->rdbk_n++;
+		srfc->frm_i = (srfc->frm_i + 1) % cntx->frm_n;
+		if (prof != 0) {
+			prof->t_sbmt[(srfc->frm_i + cntx->frm_n - 1) % cntx->frm_n] = t2;
+			vlx_ring_push(&(prof->ring[VLX_PROFILE_RECORD]), (t0 - prof->t_rec) / 1000000.0);
+			vlx_ring_push(&(prof->ring[VLX_PROFILE_SUBMIT]), (t2 - t0) / 1000000.0);
+		}
+		if (cntx->trce != 0) vlx_trace_event(cntx, "vlx_surface_swap_frame submit", 0, syscall(SYS_gettid), t0, t2);
+		return;
+	}
 	
 	VkPresentInfoKHR preinfo;
 		preinfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 		preinfo.pNext = 0;
 		preinfo.waitSemaphoreCount = 1;
-		preinfo.pWaitSemaphores = &cntx->smph_drw;
+		preinfo.pWaitSemaphores = &(srfc->smph_drw[srfc->frm_i]);
 		preinfo.swapchainCount = 1;
 		preinfo.pSwapchains = &(srfc->swap);
 		preinfo.pImageIndices = &(srfc->img_i);
 		preinfo.pResults = 0;
 	vkQueuePresentKHR(cntx->que, &preinfo);
 	
-	vkWaitForFences(cntx->devc, 1, &(cntx->fnc), 1, UINT64_MAX);
-	vkResetFences(cntx->devc, 1, &(cntx->fnc));
+	uint64_t t3 = vlx_time();
+	if (cntx->trce != 0) {
+		uint32_t tid = syscall(SYS_gettid);
+		if (prof != 0) vlx_trace_event(cntx, "record", 0, tid, prof->t_rec, t0);
+		vlx_trace_event(cntx, "vlx_surface_swap_frame submit", 0, tid, t0, t2);
+		vlx_trace_event(cntx, "vkQueuePresentKHR", 0, tid, t2, t3);
+	}
+	if (prof != 0) {
+		prof->t_sbmt[srfc->frm_i] = t2;
+		vlx_ring_push(&(prof->ring[VLX_PROFILE_RECORD]), (t0 - prof->t_rec) / 1000000.0);
+		vlx_ring_push(&(prof->ring[VLX_PROFILE_SUBMIT]), (t2 - t0) / 1000000.0);
+		vlx_ring_push(&(prof->ring[VLX_PROFILE_PRESENT]), (t3 - t2) / 1000000.0);
+	}
+	
+	srfc->frm_i = (srfc->frm_i + 1) % cntx->frm_n;
 }
 
-void vlx_surface_resize(struct vlx_context* cntx, struct vlx_surface* srfc, uint32_t w, uint32_t h) {
-	for (uint32_t i = 0; i < srfc->img_n; i++) {
+int8_t vlx_surface_read(struct vlx_context* cntx, struct vlx_surface* srfc, void* pix) {
+	if (!srfc->off || srfc->rdbk_n == 0) return 0;
+	uint32_t i = (srfc->frm_i + cntx->frm_n - 1) % cntx->frm_n;
+	vkWaitForFences(cntx->devc, 1, &(srfc->fnc[i]), 1, UINT64_MAX);
+	struct vlx_block* blck = srfc->rdbk.mem.blck;
+	if (!(cntx->mem_prop.memoryTypes[blck->type].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+		VkDeviceSize atom = cntx->prop.limits.nonCoherentAtomSize;
+		VkDeviceSize end = (srfc->rdbk.mem.off + (i + 1) * srfc->rdbk.sz + atom - 1) & ~(atom - 1);
+		VkMappedMemoryRange rng;
+			rng.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+			rng.pNext = 0;
+			rng.memory = blck->mem;
+			rng.offset = (srfc->rdbk.mem.off + i * srfc->rdbk.sz) & ~(atom - 1);
+			rng.size = ((end < blck->unit * blck->n) ? end : blck->unit * blck->n) - rng.offset;
+		vkInvalidateMappedMemoryRanges(cntx->devc, 1, &rng);
+	}
+	memcpy(pix, (uint8_t*) srfc->rdbk.mem.map + i * srfc->rdbk.sz, (uint64_t) srfc->w * srfc->h * 4);
+	return 1;
+}
+
+int8_t vlx_surface_resize(struct vlx_context* cntx, struct vlx_surface* srfc, uint32_t w, uint32_t h) {
+	vkDeviceWaitIdle(cntx->devc);
+	
+	for (uint32_t i = 0; srfc->frme != 0 && i < srfc->img_n; i++) {
 		vkDestroyFramebuffer(cntx->devc, srfc->frme[i], 0);
 	}
 	free(srfc->frme);
+	srfc->frme = 0;
 	
-	vkDestroyImageView(cntx->devc, srfc->dpth.v, 0);
-	vkDestroyImage(cntx->devc, srfc->dpth.img, 0);
-	vkFreeMemory(cntx->devc, srfc->dpth.mem, 0);
+	vlx_surface_release_depth_buffer(cntx, srfc);
 	
 	for (uint32_t i = 0; i < srfc->img_n; i++) {
 		vkDestroyImageView(cntx->devc, srfc->swap_img_v[i], 0);
 	}
+	if (srfc->off) vlx_surface_release_offscreen(cntx, srfc);
 	free(srfc->swap_img);
 	free(srfc->swap_img_v);
 	
 	srfc->w = w;
 	srfc->h = h;
 	
+	int8_t ok = vlx_surface_init_swapchain(cntx, srfc) && vlx_surface_init_depth_buffer(cntx, srfc);
+	vlx_surface_rebuild_hiz(cntx, srfc);
+	if (!ok) return 0;
+	vlx_surface_init_frame_buffer(cntx, srfc);
+	return 1;
+}
+
+uint8_t vlx_surface_present(struct vlx_context* cntx, struct vlx_surface* srfc, uint8_t mode) {
+	srfc->mode = mode;
+	if (srfc->swap == 0) return mode;
+	if (vlx_present_mode(cntx, srfc) == srfc->pres) return vlx_surface_present_mode(srfc);
+	
+	vkDeviceWaitIdle(cntx->devc);
+	uint32_t w = srfc->w;
+	uint32_t h = srfc->h;
+	
+	for (uint32_t i = 0; i < srfc->img_n; i++) {
+		if (srfc->frme != 0) vkDestroyFramebuffer(cntx->devc, srfc->frme[i], 0);
+		vkDestroyImageView(cntx->devc, srfc->swap_img_v[i], 0);
+	}
+	free(srfc->frme);
+	srfc->frme = 0;
+	free(srfc->swap_img);
+	free(srfc->swap_img_v);
+	
 	vlx_surface_init_swapchain(cntx, srfc);
-	vlx_surface_init_depth_buffer(cntx, srfc);
+	if (srfc->w != w || srfc->h != h) {
+		vlx_surface_release_depth_buffer(cntx, srfc);
+		int8_t ok = vlx_surface_init_depth_buffer(cntx, srfc);
+		vlx_surface_rebuild_hiz(cntx, srfc);
+		if (!ok) return UINT8_MAX;
+	}
 	vlx_surface_init_frame_buffer(cntx, srfc);
+	return vlx_surface_present_mode(srfc);
+}
+
+uint8_t vlx_surface_present_mode(struct vlx_surface* srfc) {
+	if (srfc->pres == VK_PRESENT_MODE_MAILBOX_KHR) return VLX_PRESENT_MAILBOX;
+	if (srfc->pres == VK_PRESENT_MODE_IMMEDIATE_KHR) return VLX_PRESENT_IMMEDIATE;
+	if (srfc->pres == VK_PRESENT_MODE_FIFO_RELAXED_KHR) return VLX_PRESENT_RELAXED;
+	return VLX_PRESENT_FIFO;
 }
 
 void vlx_buffer_destroy(struct vlx_context* cntx, struct vlx_buffer* bfr) {
-	vkDestroyBuffer(cntx->devc, bfr->bfr, 0);
-	vkFreeMemory(cntx->devc, bfr->mem, 0);
+	vlx_buffer_deinit(cntx, bfr);
 	free(bfr);
 }
 
 void vlx_image_destroy(struct vlx_context* cntx, struct vlx_image* img) {
 	vkDestroyImageView(cntx->devc, img->v, 0);
 	vkDestroyImage(cntx->devc, img->img, 0);
-	vkFreeMemory(cntx->devc, img->mem, 0);
+	vlx_memory_free(cntx, &(img->mem));
 	free(img);
 }
 
 void vlx_vertex_destroy(struct vlx_context* cntx, struct vlx_vertex* vrtx) {
+	vlx_pipeline_evict(cntx, vrtx);
 	for (uint32_t i = 0; i < vrtx->b; i++) {
-		vkDestroyBuffer(cntx->devc, vrtx->bfr[i], 0);
-		vkFreeMemory(cntx->devc, vrtx->mem[i], 0);
+		vlx_buffer_deinit(cntx, &(vrtx->bfr[i]));
 	}
 	free(vrtx->bfr);
-	free(vrtx->mem);
-	free(vrtx->req);
 	free(vrtx->bind);
 	free(vrtx->attr);
+	free(vrtx->div);
 	free(vrtx);
 }
 
 void vlx_texture_destroy(struct vlx_context* cntx, struct vlx_texture* txtr) {
+	if (!vlx_texture_ready(cntx, txtr)) vlx_transfer_wait(cntx, txtr->xfr, txtr->id);
 	vkDestroyImageView(cntx->devc, txtr->img.v, 0);
 	vkDestroyImage(cntx->devc, txtr->img.img, 0);
-	vkFreeMemory(cntx->devc, txtr->img.mem, 0);
+	vlx_memory_free(cntx, &(txtr->img.mem));
 	vkDestroySampler(cntx->devc, txtr->smpl, 0);
 	
 	free(txtr);
 }
 
 void vlx_descriptor_destroy(struct vlx_context* cntx, struct vlx_descriptor* dscr) {
+	vlx_pipeline_evict(cntx, dscr);
 	vkFreeDescriptorSets(cntx->devc, dscr->pool, dscr->n, dscr->set);
 	for (uint32_t i = 0; i < dscr->n; i++) {
 		vkDestroyDescriptorSetLayout(cntx->devc, dscr->layt[i], 0);
@@ -1168,50 +3887,151 @@ void vlx_descriptor_destroy(struct vlx_context* cntx, struct vlx_descriptor* dsc
 	
 	free(dscr->set);
 	free(dscr->layt);
+	free(dscr->type);
+	free(dscr->bind);
 	free(dscr);
 }
 
+void vlx_shader_destroy(struct vlx_context* cntx, struct vlx_shader* shdr) {
+	if (--shdr->ref > 0) return;
+	
+	struct vlx_shader** prev = &(cntx->shdr);
+	while (*prev != shdr) prev = &((*prev)->next);
+	*prev = shdr->next;
+	
+	vkDestroyShaderModule(cntx->devc, shdr->mod, 0);
+	free(shdr->code);
+	free(shdr->path);
+	free(shdr);
+}
+
 void vlx_pipeline_destroy(struct vlx_context* cntx, struct vlx_pipeline* pipe) {
+	if (--pipe->ref > 0) return;
+	
+	struct vlx_pipeline** prev = &(cntx->pipe[pipe->hash % VLX_PIPELINE_BUCKETS]);
+	while (*prev != 0 && *prev != pipe) prev = &((*prev)->next);
+	if (*prev != 0) *prev = pipe->next;
+	
 	vkDestroyPipeline(cntx->devc, pipe->pipe, 0);
 	vkDestroyPipelineLayout(cntx->devc, pipe->layt, 0);
 	free(pipe);
 }
 
+void vlx_cull_destroy(struct vlx_context* cntx, struct vlx_cull* cull) {
+	vlx_pipeline_destroy(cntx, cull->pipe);
+	vlx_descriptor_destroy(cntx, cull->tmpl);
+	vlx_descriptor_destroy(cntx, cull->dscr);
+	vlx_buffer_deinit(cntx, &(cull->obj));
+	vlx_buffer_deinit(cntx, &(cull->drw));
+	vlx_buffer_deinit(cntx, &(cull->cnt));
+	vlx_texture_destroy(cntx, cull->dmmy);
+	free(cull);
+}
+
+void vlx_hiz_destroy(struct vlx_context* cntx, struct vlx_hiz* hiz) {
+	vlx_pipeline_destroy(cntx, hiz->pipe);
+	vlx_descriptor_destroy(cntx, hiz->tmpl);
+	vlx_hiz_release(cntx, hiz);
+	struct vlx_hiz** link = &(hiz->srfc->hiz);
+	while (*link != 0 && *link != hiz) link = &((*link)->next);
+	if (*link == hiz) *link = hiz->next;
+	free(hiz);
+}
+
+void vlx_query_destroy(struct vlx_context* cntx, struct vlx_query* qry) {
+	vkDeviceWaitIdle(cntx->devc);
+	vkDestroyQueryPool(cntx->devc, qry->pool, 0);
+	struct vlx_query** link = &(qry->srfc->qry);
+	while (*link != 0 && *link != qry) link = &((*link)->next);
+	if (*link == qry) *link = qry->next;
+	free(qry->used);
+	free(qry->rslt);
+	free(qry->vld);
+	free(qry);
+}
+
+void vlx_profile_destroy(struct vlx_context* cntx, struct vlx_profile* prof) {
+	vkDeviceWaitIdle(cntx->devc);
+	if (prof->pool != 0) vkDestroyQueryPool(cntx->devc, prof->pool, 0);
+	for (uint32_t i = 0; i < prof->scp_n; i++) free(prof->name[i]);
+	if (prof->srfc->prof == prof) prof->srfc->prof = 0;
+	free(prof->name);
+	free(prof->used);
+	free(prof->ring);
+	free(prof->t_sbmt);
+	free(prof);
+}
+
 void vlx_command_destroy(struct vlx_context* cntx, struct vlx_command* cmd) {
-	vkFreeCommandBuffers(cntx->devc, cmd->pool, 1, &(cmd->draw));
+	vkFreeCommandBuffers(cntx->devc, cmd->pool, cmd->n, cmd->draw);
 	vkDestroyCommandPool(cntx->devc, cmd->pool, 0);
+	free(cmd->draw);
 	free(cmd);
 }
 
 void vlx_surface_destroy(struct vlx_context* cntx, struct vlx_surface* srfc) {
-	for (uint32_t i = 0; i < srfc->img_n; i++) {
+	vkDeviceWaitIdle(cntx->devc);
+	vlx_pipeline_evict(cntx, srfc);
+	
+	for (uint32_t i = 0; i < cntx->frm_n; i++) {
+		vkDestroySemaphore(cntx->devc, srfc->smph_img[i], 0);
+		vkDestroySemaphore(cntx->devc, srfc->smph_drw[i], 0);
+		vkDestroySemaphore(cntx->devc, srfc->smph_cmp[i], 0);
+		vkDestroySemaphore(cntx->devc, srfc->smph_gfx[i], 0);
+		vkDestroyFence(cntx->devc, srfc->fnc[i], 0);
+	}
+	free(srfc->smph_img);
+	free(srfc->smph_drw);
+	free(srfc->smph_cmp);
+	free(srfc->smph_gfx);
+	free(srfc->gfx);
+	free(srfc->fnc);
+	
+	for (uint32_t i = 0; srfc->frme != 0 && i < srfc->img_n; i++) {
 		vkDestroyFramebuffer(cntx->devc, srfc->frme[i], 0);
 	}
 	free(srfc->frme);
+	srfc->frme = 0;
 	
-	vkDestroyImageView(cntx->devc, srfc->dpth.v, 0);
-	vkDestroyImage(cntx->devc, srfc->dpth.img, 0);
-	vkFreeMemory(cntx->devc, srfc->dpth.mem, 0);
+	vlx_surface_release_depth_buffer(cntx, srfc);
 	
 	for (uint32_t i = 0; i < srfc->img_n; i++) {
 		vkDestroyImageView(cntx->devc, srfc->swap_img_v[i], 0);
 	}
+	if (srfc->off) vlx_surface_release_offscreen(cntx, srfc);
 	free(srfc->swap_img);
 	free(srfc->swap_img_v);
-	vkDestroySwapchainKHR(cntx->devc, srfc->swap, 0);
+	if (srfc->swap != 0) vkDestroySwapchainKHR(cntx->devc, srfc->swap, 0);
 	
 	vkDestroyRenderPass(cntx->devc, srfc->rndr, 0);
 	
-	vkDestroySurfaceKHR(cntx->inst, srfc->srfc, 0);
+	if (srfc->srfc != 0) vkDestroySurfaceKHR(cntx->inst, srfc->srfc, 0);
 	free(srfc);
 }
 
 void vlx_context_destroy(struct vlx_context* cntx) {
-	vkDestroySemaphore(cntx->devc, cntx->smph_img, 0);
-	vkDestroySemaphore(cntx->devc, cntx->smph_drw, 0);
-	vkDestroyFence(cntx->devc, cntx->fnc, 0);
+	vlx_transfer_destroy(cntx, &(cntx->upld));
+	vlx_transfer_destroy(cntx, &(cntx->txup));
+	
+	while (cntx->shdr != 0) {
+		cntx->shdr->ref = 1;
+		vlx_shader_destroy(cntx, cntx->shdr);
+	}
+	
+	vlx_pipeline_cache_save(cntx);
+	vkDestroyPipelineCache(cntx->devc, cntx->pipe_cache, 0);
+	free(cntx->pipe_path);
+	
+	while (cntx->blck != 0) {
+		vlx_block_destroy(cntx, cntx->blck);
+	}
 	
 	vkDestroyDevice(cntx->devc, 0);
 	vkDestroyInstance(cntx->inst, 0);
+	if (cntx->trce != 0) {
+		fprintf(cntx->trce, "\n]\n");
+		fclose(cntx->trce);
+		pthread_mutex_destroy(&(cntx->trce_lock));
+	}
 	free(cntx);
 }
@@ -17,6 +17,170 @@
 
 #include <stdint.h>
 
+/* buffer modes 
+ * 
+ * VLX_BUFFER_DYNAMIC		one region written directly by the application, data still in use by frames in flight must not be overwritten 
+ * VLX_BUFFER_STREAM		one region per frame in flight, refreshes write the region of the frame last begun on any surface and draws read it 
+ * VLX_BUFFER_STATIC		device local memory, refreshes are staged and copied to the GPU by the next upload flush 
+ **/
+
+#define VLX_BUFFER_DYNAMIC 0
+#define VLX_BUFFER_STREAM 1
+#define VLX_BUFFER_STATIC 2
+
+/* texture formats 
+ * 
+ * VLX_FORMAT_RGBA8			uncompressed 8 bit rgba 
+ * VLX_FORMAT_BC1			BC1 (DXT1) rgb(a), 8 bytes per 4x4 block 
+ * VLX_FORMAT_BC3			BC3 (DXT5) rgba, 16 bytes per 4x4 block 
+ * VLX_FORMAT_BC4			BC4 single channel, 8 bytes per 4x4 block 
+ * VLX_FORMAT_BC5			BC5 two channel, 16 bytes per 4x4 block 
+ * VLX_FORMAT_BC7			BC7 rgba, 16 bytes per 4x4 block 
+ * VLX_FORMAT_ETC2			ETC2 rgba (EAC alpha), 16 bytes per 4x4 block 
+ * VLX_FORMAT_ASTC			ASTC 4x4 rgba, 16 bytes per 4x4 block 
+ * VLX_FORMAT_R32F			uncompressed 32 bit float single channel 
+ * VLX_FORMAT_RGBA16F		uncompressed 16 bit float rgba 
+ **/
+
+#define VLX_FORMAT_RGBA8 0
+#define VLX_FORMAT_BC1 1
+#define VLX_FORMAT_BC3 2
+#define VLX_FORMAT_BC4 3
+#define VLX_FORMAT_BC5 4
+#define VLX_FORMAT_BC7 5
+#define VLX_FORMAT_ETC2 6
+#define VLX_FORMAT_ASTC 7
+#define VLX_FORMAT_R32F 8
+#define VLX_FORMAT_RGBA16F 9
+#define VLX_FORMAT_N 10
+
+/* device types 
+ * 
+ * VLX_DEVICE_OTHER			device of unknown type 
+ * VLX_DEVICE_INTEGRATED	GPU sharing memory with the host 
+ * VLX_DEVICE_DISCRETE		GPU with its own memory 
+ * VLX_DEVICE_VIRTUAL		GPU exposed by a hypervisor 
+ * VLX_DEVICE_CPU			software implementation 
+ **/
+
+#define VLX_DEVICE_OTHER 0
+#define VLX_DEVICE_INTEGRATED 1
+#define VLX_DEVICE_DISCRETE 2
+#define VLX_DEVICE_VIRTUAL 3
+#define VLX_DEVICE_CPU 4
+
+/* present modes 
+ * 
+ * VLX_PRESENT_FIFO			frames wait for vertical blank in a queue, no tearing, highest latency 
+ * VLX_PRESENT_MAILBOX		frames wait for vertical blank but replace queued ones, no tearing, low latency 
+ * VLX_PRESENT_IMMEDIATE	frames are shown as soon as they are done, may tear, lowest latency 
+ * VLX_PRESENT_RELAXED		like fifo, but late frames are shown immediately and may tear 
+ **/
+
+#define VLX_PRESENT_FIFO 0
+#define VLX_PRESENT_MAILBOX 1
+#define VLX_PRESENT_IMMEDIATE 2
+#define VLX_PRESENT_RELAXED 3
+
+/* profile metrics 
+ * 
+ * VLX_PROFILE_GPU			GPU time of the frame's primary command buffer 
+ * VLX_PROFILE_WAIT			CPU time vlx_surface_new_frame waits for the frame slot's previous submission 
+ * VLX_PROFILE_ACQUIRE		CPU time spent acquiring the swapchain image 
+ * VLX_PROFILE_RECORD		CPU time between vlx_surface_new_frame and vlx_surface_swap_frame 
+ * VLX_PROFILE_SUBMIT		CPU time ending the frame, flushing uploads and submitting 
+ * VLX_PROFILE_PRESENT		CPU time spent in the present call 
+ * VLX_PROFILE_SCOPE		GPU time of the first scope, scope i is VLX_PROFILE_SCOPE + i 
+ **/
+
+#define VLX_PROFILE_GPU 0
+#define VLX_PROFILE_WAIT 1
+#define VLX_PROFILE_ACQUIRE 2
+#define VLX_PROFILE_RECORD 3
+#define VLX_PROFILE_SUBMIT 4
+#define VLX_PROFILE_PRESENT 5
+#define VLX_PROFILE_SCOPE 6
+
+/* query types 
+ * 
+ * VLX_QUERY_OCCLUSION		number of samples that passed the depth test, or only whether any did when the device lacks precise 
+ * 							occlusion queries 
+ * VLX_QUERY_STATISTICS		VLX_QUERY_STATISTICS_N counters, in order: input vertices, input primitives, vertex shader invocations, 
+ * 							primitives reaching clipping, primitives output by clipping, fragment shader invocations 
+ **/
+
+#define VLX_QUERY_OCCLUSION 0
+#define VLX_QUERY_STATISTICS 1
+#define VLX_QUERY_STATISTICS_N 6
+
+/* format support 
+ * 
+ * VLX_SUPPORT_SAMPLED		format can be sampled by shaders 
+ * VLX_SUPPORT_FILTER		format supports linear filtering 
+ * VLX_SUPPORT_STORAGE		format can be used by vlx_texture_storage 
+ * VLX_SUPPORT_COLOR		format can be rendered to 
+ **/
+
+#define VLX_SUPPORT_SAMPLED 1
+#define VLX_SUPPORT_FILTER 2
+#define VLX_SUPPORT_STORAGE 4
+#define VLX_SUPPORT_COLOR 8
+
+#define VLX_REPORT_N 16
+
+/* descriptor types 
+ * 
+ * VLX_DESCRIPTOR_UNIFORM			uniform buffer, bound at the region of the current frame 
+ * VLX_DESCRIPTOR_TEXTURE			texture with its sampler 
+ * VLX_DESCRIPTOR_STORAGE_BUFFER	buffer read and written by shaders 
+ * VLX_DESCRIPTOR_STORAGE_IMAGE		storage texture read and written by shaders 
+ **/
+
+#define VLX_DESCRIPTOR_UNIFORM 0
+#define VLX_DESCRIPTOR_TEXTURE 1
+#define VLX_DESCRIPTOR_STORAGE_BUFFER 2
+#define VLX_DESCRIPTOR_STORAGE_IMAGE 3
+
+/* pipeline state 
+ * 
+ * Values for the fields of vlx_pipeline_state. Zero is the default for every field: triangle strips with primitive restart, no culling, 
+ * clockwise front faces, alpha blending, depth test and write with less or equal, filled polygons. Line and point polygon modes fall 
+ * back to fill when the device lacks fillModeNonSolid. 
+ **/
+
+#define VLX_TOPOLOGY_TRIANGLE_STRIP 0
+#define VLX_TOPOLOGY_TRIANGLE_LIST 1
+#define VLX_TOPOLOGY_LINE_LIST 2
+#define VLX_TOPOLOGY_LINE_STRIP 3
+#define VLX_TOPOLOGY_POINT_LIST 4
+
+#define VLX_CULL_NONE 0
+#define VLX_CULL_BACK 1
+#define VLX_CULL_FRONT 2
+
+#define VLX_FRONT_CW 0
+#define VLX_FRONT_CCW 1
+
+#define VLX_BLEND_ALPHA 0
+#define VLX_BLEND_NONE 1
+#define VLX_BLEND_ADD 2
+#define VLX_BLEND_PREMULTIPLIED 3
+
+#define VLX_DEPTH_TEST_WRITE 0
+#define VLX_DEPTH_TEST 1
+#define VLX_DEPTH_OFF 2
+
+#define VLX_COMPARE_LESS_OR_EQUAL 0
+#define VLX_COMPARE_LESS 1
+#define VLX_COMPARE_GREATER 2
+#define VLX_COMPARE_GREATER_OR_EQUAL 3
+#define VLX_COMPARE_EQUAL 4
+#define VLX_COMPARE_ALWAYS 5
+
+#define VLX_POLYGON_FILL 0
+#define VLX_POLYGON_LINE 1
+#define VLX_POLYGON_POINT 2
+
 /* vlx_context 
  * 
  * The context is a structure containing objects and values shared among all functions and objects. There should be one context for the 
@@ -51,7 +215,9 @@ struct vlx_surface;
 
 /* vlx_command 
  * 
- * The command buffer is the means of sending draw calls to the GPU. There should be one command buffer per application thread. 
+ * The command buffer is the means of sending draw calls to the GPU. There should be one command buffer per application thread. A command 
+ * structure holds its own command pool and one command buffer per frame in flight. Secondary command structures record draws on worker 
+ * threads that the primary command structure then executes. 
  **/
 
 struct vlx_command;
@@ -64,6 +230,60 @@ struct vlx_command;
 
 struct vlx_pipeline;
 
+/* vlx_shader 
+ * 
+ * The shader structure holds a compiled SPIR-V module. Shaders are reference counted and cached by the context by path and by content, 
+ * so loading the same shader again returns the existing module. 
+ **/
+
+struct vlx_shader;
+
+/* vlx_pipeline_state 
+ * 
+ * uint8_t					topology (VLX_TOPOLOGY_*) 
+ * uint8_t					cull mode (VLX_CULL_*) 
+ * uint8_t					front face (VLX_FRONT_*) 
+ * uint8_t					blend mode (VLX_BLEND_*) 
+ * uint8_t					depth mode (VLX_DEPTH_*) 
+ * uint8_t					depth compare (VLX_COMPARE_*) 
+ * uint8_t					polygon mode (VLX_POLYGON_*) 
+ * 
+ * Fixed function state of a pipeline. A zeroed structure gives the default state. 
+ **/
+
+struct vlx_pipeline_state {
+	uint8_t topo;
+	uint8_t cull;
+	uint8_t front;
+	uint8_t blend;
+	uint8_t dpth;
+	uint8_t cmp;
+	uint8_t poly;
+};
+
+/* vlx_pipeline_info 
+ * 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_shader*		vertex shader 
+ * struct vlx_shader*		fragment shader 
+ * struct vlx_vertex*		vertex structure 
+ * struct vlx_descriptor*	descriptor structure, or 0 
+ * uint64_t					size of push constants 
+ * struct vlx_pipeline_state	fixed function state 
+ * 
+ * Description of one pipeline for vlx_pipeline_get and vlx_pipeline_create_batch. 
+ **/
+
+struct vlx_pipeline_info {
+	struct vlx_surface* srfc;
+	struct vlx_shader* vert;
+	struct vlx_shader* frag;
+	struct vlx_vertex* vrtx;
+	struct vlx_descriptor* dscr;
+	uint64_t push_sz;
+	struct vlx_pipeline_state state;
+};
+
 /* vlx_vertex 
  * 
  * The vertex structure contains the vertex buffer, a buffer for sharing vertices between the application and the vertex shader, and 
@@ -88,14 +308,191 @@ struct vlx_texture;
 
 struct vlx_descriptor;
 
+/* vlx_cull 
+ * 
+ * The cull structure holds the objects of a GPU frustum culling pass and the indirect draw commands it produces. The pass runs the 
+ * compute shader from src/shd/cull.comp, which make.sh compiles to vlx_cull.spv. 
+ **/
+
+struct vlx_cull;
+
+/* vlx_hiz 
+ * 
+ * The hiz structure holds a hierarchical depth pyramid of a surface, each level keeping the farthest depth of the texels below it. 
+ * It is built by the compute shader from src/shd/hiz.comp, which make.sh compiles to vlx_hiz.spv. 
+ **/
+
+struct vlx_hiz;
+
+/* vlx_profile 
+ * 
+ * The profile structure holds the timestamp queries and timing history of a surface's frames. 
+ **/
+
+struct vlx_profile;
+
+/* vlx_query 
+ * 
+ * The query structure holds a ring of occlusion or pipeline statistics queries, one set of slots per frame in flight. 
+ **/
+
+struct vlx_query;
+
+/* vlx_profile_stats 
+ * 
+ * uint32_t					number of samples, up to the last 256 frames 
+ * double					last sample 
+ * double					mean 
+ * double					median 
+ * double					99th percentile 
+ * double					maximum 
+ * 
+ * Statistics of one profile metric, in milliseconds, filled by vlx_profile_stats. 
+ **/
+
+struct vlx_profile_stats {
+	uint32_t n;
+	double last;
+	double mean;
+	double p50;
+	double p99;
+	double max;
+};
+
+/* vlx_cull_object 
+ * 
+ * float[3]					bounding volume center 
+ * float					bounding sphere radius, or 0 to test the box 
+ * float[3]					bounding box half extents 
+ * float					unused 
+ * uint32_t					number of indices 
+ * uint32_t					number of instances 
+ * uint32_t					index offset 
+ * int32_t					vertex offset 
+ * uint32_t					first instance 
+ * uint32_t[3]				unused 
+ * 
+ * One object for vlx_cull, a world space bounding sphere or axis aligned box followed by the indexed draw that renders it. 64 bytes, 
+ * laid out to match the shader. 
+ **/
+
+struct vlx_cull_object {
+	float cntr[3];
+	float rad;
+	float ext[3];
+	float pad0;
+	uint32_t indx_n;
+	uint32_t inst_n;
+	uint32_t indx_off;
+	int32_t vrtx_off;
+	uint32_t inst_i;
+	uint32_t pad1[3];
+};
+
+/* vlx_device_report 
+ * 
+ * char[256]				device name 
+ * uint8_t					device type, one of VLX_DEVICE_ 
+ * uint32_t					vendor ID 
+ * uint32_t					device ID 
+ * uint32_t					supported Vulkan version 
+ * uint32_t					driver version 
+ * uint32_t					number of memory heaps 
+ * uint64_t[16]				size of each memory heap in bytes 
+ * uint8_t[16]				boolean for device local heaps 
+ * uint32_t					number of queue families 
+ * uint32_t[16]				VkQueueFlags of each queue family 
+ * uint32_t[16]				number of queues in each queue family 
+ * uint32_t					queue family used for graphics 
+ * uint32_t					queue family used for async compute 
+ * uint32_t					queue family used for texture uploads 
+ * uint32_t					maximum texture width and height 
+ * uint32_t					maximum push constant size 
+ * uint32_t					maximum uniform buffer range 
+ * uint32_t					maximum storage buffer range 
+ * uint32_t					maximum draws per indirect call 
+ * uint32_t					maximum compute workgroup invocations 
+ * uint32_t					sample counts supported for color and depth, as a bit mask 
+ * float					maximum sampler anisotropy, 1 when unsupported 
+ * float					nanoseconds per timestamp tick 
+ * uint8_t					boolean for line and point polygon modes 
+ * uint8_t					boolean for count driven indirect draws 
+ * uint8_t					boolean for per-instance vertex stream divisors 
+ * uint8_t[VLX_FORMAT_N]	VLX_SUPPORT_ flags of each texture format 
+ * 
+ * Capabilities of the device chosen by vlx_context_create, filled by vlx_context_report. Heaps and queue families past 16 are not 
+ * listed. 
+ **/
+
+struct vlx_device_report {
+	char name[256];
+	uint8_t type;
+	uint32_t vndr;
+	uint32_t id;
+	uint32_t api;
+	uint32_t drvr;
+	uint32_t heap_n;
+	uint64_t heap_sz[VLX_REPORT_N];
+	uint8_t heap_lcl[VLX_REPORT_N];
+	uint32_t fam_n;
+	uint32_t fam_flag[VLX_REPORT_N];
+	uint32_t fam_que[VLX_REPORT_N];
+	uint32_t que_i;
+	uint32_t cmp_i;
+	uint32_t xfr_i;
+	uint32_t img_max;
+	uint32_t push_max;
+	uint32_t ubo_max;
+	uint32_t ssbo_max;
+	uint32_t draw_max;
+	uint32_t wg_max;
+	uint32_t smpl;
+	float aniso;
+	float ts;
+	uint8_t non_solid;
+	uint8_t draw_cnt;
+	uint8_t div;
+	uint8_t frmt[VLX_FORMAT_N];
+};
+
 /* vlx_context_create 
  * 
  * int8_t					boolean for non-linear color scheme 
+ * uint8_t					number of frames in flight 
+ * const char*				pipeline cache file path, or 0 
+ * const char*				device selector, or 0 
+ * 
+ * Creates a Vulkan context for the application. The number of frames in flight is the number of frames the application can record while 
+ * the GPU is still rendering previous ones, 2 or 3 is recommended. The context owns a pipeline cache used by all pipeline creation. If a 
+ * path is given, the cache is seeded from that file when its header matches the device's vendor, device ID and cache UUID, and written 
+ * back to it by vlx_context_destroy. Besides the graphics queue, a queue from a compute-only family is created for async compute when the 
+ * device has one, and a queue from a transfer-only family for texture uploads. Buffers and images are shared concurrently between the 
+ * families in use, so no ownership transfers are needed. 
+ * 
+ * The device selector is "discrete", "integrated", "virtual" or "cpu" to prefer a device type, a decimal index into the devices the 
+ * loader reports, or a substring of the device name. The VLX_DEVICE environment variable overrides it. Devices without a graphics queue 
+ * are skipped, and when nothing matches the device with swapchain support, the best type and the most device local memory is used. 
+ * Only the device features the library uses are enabled. The Wayland surface and swapchain extensions are only enabled when present, 
+ * so contexts can be created on headless systems and software drivers and used with vlx_surface_create_offscreen. 
+ * 
+ * When the VLX_TRACE environment variable names a file, the context writes a Chrome trace (JSON array format, viewable in 
+ * chrome://tracing or Perfetto) to it until vlx_context_destroy. CPU spans cover context, shader, pipeline and texture creation, upload 
+ * flushes and fence waits, and each frame's fence wait, acquire, recording, submit and present. Surfaces with a vlx_profile also emit 
+ * their GPU frame and scope timestamps on the same timeline, calibrated with VK_EXT_calibrated_timestamps when the device has it and 
+ * anchored to the submit time otherwise. Without the variable tracing costs one branch per span. 
+ **/
+
+struct vlx_context* vlx_context_create(int8_t, uint8_t, const char*, const char*);
+
+/* vlx_context_report 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_device_report*	report to fill 
  * 
- * Creates a Vulkan context for the application. 
+ * Fills a report of the capabilities of the context's device, to choose quality and performance settings at startup. 
  **/
 
-struct vlx_context* vlx_context_create(int8_t);
+void vlx_context_report(struct vlx_context*, struct vlx_device_report*);
 
 /* vlx_surface_create 
  * 
@@ -105,11 +502,25 @@ struct vlx_context* vlx_context_create(int8_t);
  * uint16_t					width 
  * uint16_t					height 
  * 
- * Creates a Vulkan surface from a Wayland client surface. Should be called per application window. 
+ * Creates a Vulkan surface from a Wayland client surface. Should be called per application window. Returns 0 when the Vulkan 
+ * implementation has no Wayland surface or swapchain support. 
  **/
 
 struct vlx_surface* vlx_surface_create(struct vlx_context*, void*, void*, uint16_t, uint16_t);
 
+/* vlx_surface_create_offscreen 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * uint16_t					width 
+ * uint16_t					height 
+ * 
+ * Creates a surface that renders to its own color images instead of a window, one per frame in flight, for batch rendering, 
+ * thumbnails and tests without a display. It is initialized, drawn to, swapped, resized and destroyed like a window surface, but 
+ * vlx_surface_swap_frame copies the frame to host memory instead of presenting it, for vlx_surface_read. 
+ **/
+
+struct vlx_surface* vlx_surface_create_offscreen(struct vlx_context*, uint16_t, uint16_t);
+
 /* vlx_command_create 
  * 
  * struct vlx_context*		Vulkan context 
@@ -119,6 +530,28 @@ struct vlx_surface* vlx_surface_create(struct vlx_context*, void*, void*, uint16
 
 struct vlx_command* vlx_command_create(struct vlx_context*);
 
+/* vlx_command_create_secondary 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * 
+ * Creates command pool and secondary command buffers. Create one per recording thread, since a command pool must only be used by one 
+ * thread at a time. 
+ **/
+
+struct vlx_command* vlx_command_create_secondary(struct vlx_context*);
+
+/* vlx_command_create_compute 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * 
+ * Creates command pool and buffers for the async compute queue. Record with vlx_compute_begin, the vlx_compute_dispatch functions and 
+ * vlx_cull_dispatch, then submit with vlx_compute_submit. Falls back to the graphics family when the device has no compute-only family. 
+ * Buffers written by async compute should have one region per frame in flight, like streamed buffers and cull structures, since 
+ * graphics work of earlier frames may still be reading the other regions. 
+ **/
+
+struct vlx_command* vlx_command_create_compute(struct vlx_context*);
+
 /* vlx_surface_init_render_pass 
  * 
  * struct vlx_context*		Vulkan context 
@@ -134,20 +567,22 @@ void vlx_surface_init_render_pass(struct vlx_context*, struct vlx_surface*);
  * struct vlx_context*		Vulkan context 
  * struct vlx_surface*		Vulkan surface 
  * 
- * Initializes swapchain for a surface. 
+ * Initializes swapchain for a surface. The present mode is the one set with vlx_surface_present, fifo by default. The swapchain has 
+ * one image more than the frames in flight, at least 3 for mailbox, clamped to what the surface supports. Returns 0 if device memory 
+ * for the images of an offscreen surface cannot be allocated. 
  **/
 
-void vlx_surface_init_swapchain(struct vlx_context*, struct vlx_surface*);
+int8_t vlx_surface_init_swapchain(struct vlx_context*, struct vlx_surface*);
 
 /* vlx_surface_init_depth_buffer 
  * 
  * struct vlx_context*		Vulkan context 
  * struct vlx_surface*		Vulkan surface 
  * 
- * Initializes depth buffer for a surface. 
+ * Initializes depth buffer for a surface. Returns 0 if device memory cannot be allocated. 
  **/
 
-void vlx_surface_init_depth_buffer(struct vlx_context*, struct vlx_surface*);
+int8_t vlx_surface_init_depth_buffer(struct vlx_context*, struct vlx_surface*);
 
 /* vlx_surface_init_frame_buffer 
  * 
@@ -159,19 +594,92 @@ void vlx_surface_init_depth_buffer(struct vlx_context*, struct vlx_surface*);
 
 void vlx_surface_init_frame_buffer(struct vlx_context*, struct vlx_surface*);
 
+/* vlx_shader_create 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * const uint32_t*			SPIR-V code 
+ * uint64_t					size of code in bytes 
+ * 
+ * Creates a shader from SPIR-V in memory, such as a blob embedded in the executable. The code is only read during the call. If a shader 
+ * with the same content already exists, its reference count is incremented and it is returned instead. 
+ **/
+
+struct vlx_shader* vlx_shader_create(struct vlx_context*, const uint32_t*, uint64_t);
+
+/* vlx_shader_load 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * const char*				path to a SPIR-V file 
+ * 
+ * Creates a shader from a file by memory mapping it. Returns the cached shader if the path or content was loaded before, or 0 if the 
+ * file cannot be read. Every load must be matched by a vlx_shader_destroy. 
+ **/
+
+struct vlx_shader* vlx_shader_load(struct vlx_context*, const char*);
+
 /* vlx_pipeline_create 
  * 
  * struct vlx_context*		Vulkan context 
  * struct vlx_surface*		Vulkan surface 
- * int8_t*					path to the vertex shader 
- * int8_t*					path to the fragment shader 
+ * struct vlx_shader*		vertex shader 
+ * struct vlx_shader*		fragment shader 
  * struct vlx_vertex*		vertex structure 
  * struct vlx_descriptor*	descriptor structure 
  * 
- * Creates pipeline. 
+ * Creates pipeline with the default state, same as vlx_pipeline_get with a zeroed state. The shaders can be destroyed afterwards. 
  **/
 
-struct vlx_pipeline* vlx_pipeline_create(struct vlx_context*, struct vlx_surface*, int8_t*, int8_t*, struct vlx_vertex*, struct vlx_descriptor*, uint64_t);
+struct vlx_pipeline* vlx_pipeline_create(struct vlx_context*, struct vlx_surface*, struct vlx_shader*, struct vlx_shader*, struct vlx_vertex*, struct vlx_descriptor*, uint64_t);
+
+/* vlx_pipeline_get 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * const struct vlx_pipeline_info*	pipeline description 
+ * 
+ * Returns the pipeline for the description. Pipelines are cached by a hash of the description, with shaders keyed by content, so a 
+ * repeated description returns the existing pipeline with its reference count incremented. Reconfiguring the vertex structure with 
+ * vlx_vertex_conf gives it a new key, and destroying a surface, vertex structure or descriptor drops its pipelines from the cache, 
+ * so a later object at the same address never gets a stale pipeline. Every call must be matched by a vlx_pipeline_destroy. 
+ **/
+
+struct vlx_pipeline* vlx_pipeline_get(struct vlx_context*, const struct vlx_pipeline_info*);
+
+/* vlx_pipeline_create_batch 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * const struct vlx_pipeline_info*	array of pipeline descriptions 
+ * uint32_t					number of pipelines 
+ * struct vlx_pipeline**	array receiving the created pipelines 
+ * uint32_t					number of threads, 0 for one per core 
+ * 
+ * Gets pipelines like vlx_pipeline_get, compiling the ones not already cached concurrently on worker threads that take descriptions 
+ * from a shared counter, and returns once all are done. The calling thread works as well. All threads compile against the context 
+ * pipeline cache. Shaders must be loaded beforehand and must not be destroyed during the call. 
+ **/
+
+void vlx_pipeline_create_batch(struct vlx_context*, const struct vlx_pipeline_info*, uint32_t, struct vlx_pipeline**, uint32_t);
+
+/* vlx_pipeline_compute 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_shader*		compute shader 
+ * struct vlx_descriptor*	descriptor structure, or 0 
+ * uint64_t					size of push constants 
+ * 
+ * Returns the compute pipeline for the shader, cached like vlx_pipeline_get. Every call must be matched by a vlx_pipeline_destroy. 
+ **/
+
+struct vlx_pipeline* vlx_pipeline_compute(struct vlx_context*, struct vlx_shader*, struct vlx_descriptor*, uint64_t);
+
+/* vlx_pipeline_cache_save 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * 
+ * Writes the pipeline cache to the path given to vlx_context_create, through a temporary file that is renamed into place so a crash 
+ * never leaves a partial cache. Returns 1 on success, 0 if no path was given or the write failed. 
+ **/
+
+int8_t vlx_pipeline_cache_save(struct vlx_context*);
 
 /* vlx_buffer_refresh 
  * 
@@ -179,11 +687,13 @@ struct vlx_pipeline* vlx_pipeline_create(struct vlx_context*, struct vlx_surface
  * struct vlx_buffer*		Vulkan buffer 
  * void*					memory 
  * uint64_t					size of memory to refresh 
+ * uint64_t					offset of memory to refresh 
  * 
- * Refreshes Vulkan buffer. This function can be used to transfer data from CPU memory to GPU memory. 
+ * Refreshes Vulkan buffer. This function can be used to transfer data from CPU memory to GPU memory. Buffers stay mapped for their whole 
+ * lifetime, so only the given range is copied. Streamed buffers should be refreshed after vlx_surface_new_frame. 
  **/
 
-void vlx_buffer_refresh(struct vlx_context*, struct vlx_buffer*, void*, uint64_t);
+void vlx_buffer_refresh(struct vlx_context*, struct vlx_buffer*, void*, uint64_t, uint64_t);
 
 /* vlx_vertex_create 
  * 
@@ -191,11 +701,13 @@ void vlx_buffer_refresh(struct vlx_context*, struct vlx_buffer*, void*, uint64_t
  * uint32_t					number of bindings 
  * uint32_t					number of attributes 
  * uint64_t					size of vertex buffer 
+ * uint8_t					buffer mode 
  * 
  * Creates vertex structure.
+ * Returns 0 if device memory cannot be allocated. 
  **/
 
-struct vlx_vertex* vlx_vertex_create(struct vlx_context*, uint32_t, uint32_t, uint64_t);
+struct vlx_vertex* vlx_vertex_create(struct vlx_context*, uint32_t, uint32_t, uint64_t, uint8_t);
 
 /* vlx_vertex_bind 
  * 
@@ -208,6 +720,19 @@ struct vlx_vertex* vlx_vertex_create(struct vlx_context*, uint32_t, uint32_t, ui
 
 void vlx_vertex_bind(struct vlx_vertex*, uint32_t, uint32_t);
 
+/* vlx_vertex_bind_instance 
+ * 
+ * struct vlx_vertex*		vertex structure 
+ * uint32_t					binding index 
+ * uint32_t					binding stride 
+ * uint32_t					instance divisor 
+ * 
+ * Sets the stride of a binding that advances once per instance instead of once per vertex. A divisor greater than 1 repeats each 
+ * element for that many instances where VK_EXT_vertex_attribute_divisor is supported, and is treated as 1 otherwise. 
+ **/
+
+void vlx_vertex_bind_instance(struct vlx_vertex*, uint32_t, uint32_t, uint32_t);
+
 /* vlx_vertex_attr 
  * 
  * struct vlx_context*		Vulkan context 
@@ -232,62 +757,213 @@ void vlx_vertex_attr(struct vlx_vertex*, uint32_t, uint32_t, int8_t, uint32_t);
 
 void vlx_vertex_conf(struct vlx_vertex*);
 
+/* vlx_vertex_instance 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_vertex*		vertex structure 
+ * uint32_t					binding index 
+ * uint32_t					first attribute location 
+ * uint32_t					maximum number of instances 
+ * 
+ * Turns a binding into a per-instance stream of 4x4 float transforms. The binding buffer is replaced by a streamed buffer of 64 bytes per 
+ * instance, and the four attributes starting at the given location read the matrix columns as vec4s. Should be called before 
+ * vlx_vertex_conf, and the transforms should be refreshed with vlx_vertex_refresh after every vlx_surface_new_frame. Returns 0 and 
+ * leaves the binding untouched if device memory cannot be allocated. 
+ **/
+
+int8_t vlx_vertex_instance(struct vlx_context*, struct vlx_vertex*, uint32_t, uint32_t, uint32_t);
+
 /* vlx_vertex_refresh
  * 
  * struct vlx_context*		Vulkan context 
  * struct vlx_vertex*		vertex structure 
+ * uint32_t					binding index 
  * void*					memory 
  * uint64_t					size of memory to refresh 
  * uint64_t					offset of memory to refresh 
  * 
- * Refreshes vertex buffer. This function can be used to transfer data from CPU memory to GPU memory. 
+ * Refreshes vertex buffer. This function can be used to transfer data from CPU memory to GPU memory. Streamed buffers should be refreshed 
+ * after vlx_surface_new_frame. 
+ **/
+
+void vlx_vertex_refresh(struct vlx_context*, struct vlx_vertex*, uint32_t, void*, uint64_t, uint64_t);
+
+/* vlx_vertex_buffer 
+ * 
+ * struct vlx_vertex*		vertex structure 
+ * uint32_t					binding index 
+ * 
+ * Returns the buffer of a binding, so it can be written by compute shaders through vlx_descriptor_buffer. The buffer is owned by the 
+ * vertex structure and must not be destroyed. 
  **/
 
-void vlx_vertex_refresh(struct vlx_context*, struct vlx_vertex*, uint32_t, void*, uint64_t);
+struct vlx_buffer* vlx_vertex_buffer(struct vlx_vertex*, uint32_t);
 
 /* vlx_index_create 
  * 
  * struct vlx_context*		Vulkan context 
  * uint64_t					size of buffer 
+ * uint8_t					buffer mode 
  * 
  * Creates an index buffer. 
+ * Returns 0 if device memory cannot be allocated. 
  **/
 
-struct vlx_buffer* vlx_index_create(struct vlx_context*, uint64_t);
+struct vlx_buffer* vlx_index_create(struct vlx_context*, uint64_t, uint8_t);
+
+/* vlx_indirect_create 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * uint64_t					size of buffer 
+ * uint8_t					buffer mode 
+ * 
+ * Creates a buffer for indirect draw commands and draw counts. Commands are laid out as VkDrawIndexedIndirectCommand, 5 uint32_t 
+ * values each (index count, instance count, first index, vertex offset, first instance), and a count is one uint32_t. The buffer can 
+ * also be written by compute shaders as a storage buffer. 
+ * Returns 0 if device memory cannot be allocated. 
+ **/
+
+struct vlx_buffer* vlx_indirect_create(struct vlx_context*, uint64_t, uint8_t);
+
+/* vlx_storage_create 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * uint64_t					size of buffer 
+ * uint8_t					buffer mode 
+ * 
+ * Creates a storage buffer for compute shaders. The buffer can also be used as an indirect, vertex or index buffer, so results of a 
+ * dispatch can be drawn without a copy. 
+ * Returns 0 if device memory cannot be allocated. 
+ **/
+
+struct vlx_buffer* vlx_storage_create(struct vlx_context*, uint64_t, uint8_t);
 
 /* vlx_uniform_create 
  * 
  * struct vlx_context*		Vulkan context 
  * uint64_t					size of buffer 
  * 
- * Creates a uniform buffer. 
+ * Creates a uniform buffer with one region per frame in flight. The first vlx_descriptor_write fills every region, so a uniform written 
+ * once stays valid, and later writes go to the region of the current frame, which descriptors bind by dynamic offset so frames still in 
+ * flight keep reading their own copy. Per-frame writes must come after vlx_surface_new_frame. The current frame is that of the surface 
+ * that last began a frame, so several surfaces sharing uniforms must begin and swap their frames in lockstep. 
+ * Returns 0 if device memory cannot be allocated. 
  **/
 
 struct vlx_buffer* vlx_uniform_create(struct vlx_context*, uint64_t);
 
+/* vlx_upload_flush 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * 
+ * Submits all pending static buffer refreshes and texture loads as batches of copies. Called by vlx_surface_swap_frame, but can be 
+ * called after loading to start the transfer early. 
+ **/
+
+void vlx_upload_flush(struct vlx_context*);
+
+/* vlx_texture_load 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * uint8_t*					pixel data (rgba)
+ * uint32_t					width 
+ * uint32_t					height 
+ * uint8_t					generate mipmaps (1) or not (0) 
+ * 
+ * Creates texture and queues its pixel data for upload, returning immediately. Uploads are batched with other loads and submitted 
+ * on a dedicated transfer queue when the device has one. The texture may be bound once vlx_texture_ready returns 1. If mipmaps are 
+ * requested and the format supports linear blits, the full mip chain is generated on the graphics queue after the upload and the 
+ * sampler uses trilinear filtering with the device's maximum anisotropy. 
+ * Returns 0 if device memory cannot be allocated. 
+ **/
+
+struct vlx_texture* vlx_texture_load(struct vlx_context*, uint8_t*, uint32_t, uint32_t, uint8_t);
+
+/* vlx_format_supported 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * uint8_t					texture format (VLX_FORMAT_*) 
+ * 
+ * Returns 1 if the device can sample textures of the format with optimal tiling, 0 otherwise. 
+ **/
+
+int8_t vlx_format_supported(struct vlx_context*, uint8_t);
+
+/* vlx_texture_file 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * const char*				path to a KTX2 or DDS file 
+ * 
+ * Memory maps the file and queues every mip level it contains for upload, copying straight from the mapping into staging memory. 
+ * Returns immediately like vlx_texture_load, or 0 if the file cannot be read, is supercompressed, holds an array, cube or 3D 
+ * image, or its format is unknown or not supported by the device. Files whose size exceeds the device's image dimension limit, 
+ * whose level count exceeds a full mip chain or whose levels reach past the end of the file are rejected as well, as are files 
+ * that do not fit in device memory. Callers can pick between files with vlx_format_supported. 
+ **/
+
+struct vlx_texture* vlx_texture_file(struct vlx_context*, const char*);
+
+/* vlx_texture_storage 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * uint32_t					width 
+ * uint32_t					height 
+ * uint8_t					texture format (VLX_FORMAT_*) 
+ * 
+ * Creates a texture that compute shaders can write as a storage image and all shaders can sample. The texture stays in the general 
+ * layout for its whole lifetime. Returns 0 if the device cannot use the format for storage images or device memory cannot be 
+ * allocated. 
+ **/
+
+struct vlx_texture* vlx_texture_storage(struct vlx_context*, uint32_t, uint32_t, uint8_t);
+
+/* vlx_texture_ready 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_texture*		texture 
+ * 
+ * Returns 1 if the texture upload has completed, 0 otherwise. Does not block. 
+ **/
+
+int8_t vlx_texture_ready(struct vlx_context*, struct vlx_texture*);
+
 /* vlx_texture_create 
  * 
  * struct vlx_context*		Vulkan context 
- * struct vlx_command*		command structure 
+ * struct vlx_command*		command structure (unused)
  * uint8_t*					pixel data (rgba)
  * uint32_t					width 
  * uint32_t					height 
+ * uint8_t					generate mipmaps (1) or not (0) 
  * 
- * Creates texture.
+ * Creates texture and waits for its upload to complete.
+ * Returns 0 if device memory cannot be allocated. 
  **/
 
-struct vlx_texture* vlx_texture_create(struct vlx_context*, struct vlx_command*, uint8_t*, uint32_t, uint32_t);
+struct vlx_texture* vlx_texture_create(struct vlx_context*, struct vlx_command*, uint8_t*, uint32_t, uint32_t, uint8_t);
 
 /* vlx_descriptor_create 
  * 
  * struct vlx_context*		Vulkan context 
  * uint32_t					number of descriptors 
  * 
- * Creates descriptors.
+ * Creates descriptors with a uniform buffer at binding 0 and a texture at binding 1.
  **/
 
 struct vlx_descriptor* vlx_descriptor_create(struct vlx_context*, uint32_t);
 
+/* vlx_descriptor_layout 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * uint32_t					number of descriptors 
+ * const uint8_t*			descriptor type of each binding (VLX_DESCRIPTOR_*) 
+ * uint32_t					number of bindings 
+ * 
+ * Creates descriptors with the given bindings, visible to vertex, fragment and compute shaders. 
+ **/
+
+struct vlx_descriptor* vlx_descriptor_layout(struct vlx_context*, uint32_t, const uint8_t*, uint32_t);
+
 /* vlx_descriptor_write 
  * 
  * struct vlx_context*		Vulkan context 
@@ -298,11 +974,44 @@ struct vlx_descriptor* vlx_descriptor_create(struct vlx_context*, uint32_t);
  * uint64_t					uniform size 
  * struct vlx_texture*		texture 
  * 
- * Writes descriptors. 
+ * Writes uniform memory into the region of the current frame and points the descriptor at the buffer and texture. The first write 
+ * to a uniform buffer fills all of its regions. Later writes must come after vlx_surface_new_frame, or they land in the region of 
+ * the previous frame, which may still be in flight. The descriptor itself is only rewritten when the buffer or texture changes, which 
+ * must not happen while frames using it are in flight. 
  **/
 
 void vlx_descriptor_write(struct vlx_context*, struct vlx_descriptor*, uint32_t, struct vlx_buffer*, void*, uint64_t, struct vlx_texture*);
 
+/* vlx_descriptor_buffer 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_descriptor*	descriptor structure 
+ * uint32_t					descriptor index 
+ * uint32_t					binding 
+ * struct vlx_buffer*		uniform or storage buffer 
+ * uint64_t					offset 
+ * uint64_t					size, 0 for the rest of the buffer 
+ * 
+ * Points a buffer binding at a range of the buffer. Uniform bindings are offset to the region of the current frame when bound, so the 
+ * range is relative to one region and defaults to the rest of it. Storage bindings of streamed buffers should be given their range 
+ * explicitly. Must not be called while frames using the descriptor are in flight. 
+ **/
+
+void vlx_descriptor_buffer(struct vlx_context*, struct vlx_descriptor*, uint32_t, uint32_t, struct vlx_buffer*, uint64_t, uint64_t);
+
+/* vlx_descriptor_image 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_descriptor*	descriptor structure 
+ * uint32_t					descriptor index 
+ * uint32_t					binding 
+ * struct vlx_texture*		texture 
+ * 
+ * Points a texture or storage image binding at a texture. Storage image bindings take textures from vlx_texture_storage. 
+ **/
+
+void vlx_descriptor_image(struct vlx_context*, struct vlx_descriptor*, uint32_t, uint32_t, struct vlx_texture*);
+
 /* vlx_surface_clear 
  * 
  * struct vlx_context*		Vulkan context 
@@ -320,11 +1029,53 @@ void vlx_surface_clear(struct vlx_surface*, uint8_t, uint8_t, uint8_t);
  * struct vlx_context*		Vulkan context 
  * struct vlx_surface*		Vulkan surface 
  * struct vlx_command*		command structure 
+ * uint8_t					draws are recorded in secondary command structures (1) or directly (0) 
+ * 
+ * Signals new surface frame to the command buffer. Should be called once per frame before any drawing. Waits only until the GPU is done 
+ * with the frame last recorded in the same frame slot. If secondary recording is chosen, the frame may only contain 
+ * vlx_surface_execute_frame calls. The render pass begins with the first draw or execute, so compute dispatches must be recorded 
+ * before it. 
+ **/
+
+void vlx_surface_new_frame(struct vlx_context*, struct vlx_surface*, struct vlx_command*, uint8_t);
+
+/* vlx_command_begin 
  * 
- * Signals new surface frame to the command buffer. Should be called once per frame before any drawing. 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		secondary command structure 
+ * 
+ * Begins recording the secondary command buffer of the current frame, inheriting the surface render pass and frame buffer. Must be 
+ * called after vlx_surface_new_frame and may be called from any thread, each with its own command structure. Draws are then recorded 
+ * with vlx_surface_draw_frame on the secondary command structure. 
  **/
 
-void vlx_surface_new_frame(struct vlx_context*, struct vlx_surface*, struct vlx_command*);
+void vlx_command_begin(struct vlx_context*, struct vlx_surface*, struct vlx_command*);
+
+/* vlx_command_end 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		secondary command structure 
+ * 
+ * Ends recording the secondary command buffer of the current frame. 
+ **/
+
+void vlx_command_end(struct vlx_context*, struct vlx_surface*, struct vlx_command*);
+
+/* vlx_surface_execute_frame 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		primary command structure 
+ * struct vlx_command**		secondary command structures 
+ * uint32_t					number of secondary command structures 
+ * 
+ * Executes the recorded secondary command buffers in array order, so the result does not depend on which thread finished first. Call 
+ * after every vlx_command_end and before vlx_surface_swap_frame. 
+ **/
+
+void vlx_surface_execute_frame(struct vlx_context*, struct vlx_surface*, struct vlx_command*, struct vlx_command**, uint32_t);
 
 /* vlx_surface_draw_frame 
  * 
@@ -341,11 +1092,361 @@ void vlx_surface_new_frame(struct vlx_context*, struct vlx_surface*, struct vlx_
  * uint32_t					index offset 
  * uint32_t					vertex offset 
  * 
- * Draws frame given pipeline and buffers. Can be called multiple times per frame. 
+ * Draws frame given pipeline and buffers. Can be called multiple times per frame. The command structure tracks the state bound by 
+ * previous draws since vlx_surface_new_frame or vlx_command_begin and skips binds, dynamic state and push constants that did not change. 
  **/
 
 void vlx_surface_draw_frame(struct vlx_context*, struct vlx_surface*, struct vlx_pipeline*, struct vlx_command*, struct vlx_buffer*, struct vlx_vertex*, struct vlx_descriptor*, void*, uint64_t, uint32_t, uint32_t, uint32_t);
 
+/* vlx_surface_draw_instanced 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_pipeline*		Vulkan pipeline 
+ * struct vlx_command*		command structure 
+ * struct vlx_buffer*		index buffer 
+ * struct vlx_vertex*		vertex buffer 
+ * struct vlx_descriptor*	descriptor structure 
+ * void*					push constant
+ * uint64_t					size of push constanst 
+ * uint32_t					number of indices 
+ * uint32_t					index offset 
+ * uint32_t					vertex offset 
+ * uint32_t					number of instances 
+ * uint32_t					first instance 
+ * 
+ * Same as vlx_surface_draw_frame, but draws the given range of instances in one call. 
+ **/
+
+void vlx_surface_draw_instanced(struct vlx_context*, struct vlx_surface*, struct vlx_pipeline*, struct vlx_command*, struct vlx_buffer*, struct vlx_vertex*, struct vlx_descriptor*, void*, uint64_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+
+/* vlx_surface_draw_indirect 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_pipeline*		Vulkan pipeline 
+ * struct vlx_command*		command structure 
+ * struct vlx_buffer*		index buffer 
+ * struct vlx_vertex*		vertex buffer 
+ * struct vlx_descriptor*	descriptor structure 
+ * void*					push constant
+ * uint64_t					size of push constanst 
+ * struct vlx_buffer*		indirect buffer holding draw commands 
+ * uint64_t					offset of the first draw command 
+ * uint32_t					maximum number of draw commands 
+ * struct vlx_buffer*		indirect buffer holding the draw count, or 0 
+ * uint64_t					offset of the draw count 
+ * 
+ * Draws from commands stored in a GPU buffer with shared pipeline and buffers. With a count buffer, the GPU reads the number of draws 
+ * from it, up to the maximum, using VK_KHR_draw_indirect_count. Where that extension is missing all commands up to the maximum are 
+ * drawn, so unused commands should have an instance count of 0. 
+ **/
+
+void vlx_surface_draw_indirect(struct vlx_context*, struct vlx_surface*, struct vlx_pipeline*, struct vlx_command*, struct vlx_buffer*, struct vlx_vertex*, struct vlx_descriptor*, void*, uint64_t, struct vlx_buffer*, uint64_t, uint32_t, struct vlx_buffer*, uint64_t);
+
+/* vlx_compute_dispatch 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		primary command structure 
+ * struct vlx_pipeline*		compute pipeline 
+ * struct vlx_descriptor*	descriptor structure, or 0 
+ * void*					push constant 
+ * uint64_t					size of push constants 
+ * uint32_t					number of workgroups in x 
+ * uint32_t					number of workgroups in y 
+ * uint32_t					number of workgroups in z 
+ * 
+ * Records a compute dispatch into the frame. Must be called after vlx_surface_new_frame and before the first draw. Barriers are 
+ * recorded so the dispatch waits for earlier shader writes and earlier frames to stop reading its buffers, and later dispatches and 
+ * draws see its writes as indirect commands, vertices, indices, uniforms or shader reads. Returns 1 if the dispatch was recorded, or 
+ * 0 if it was not because the render pass has already begun or the command structure is secondary. 
+ **/
+
+int8_t vlx_compute_dispatch(struct vlx_context*, struct vlx_surface*, struct vlx_command*, struct vlx_pipeline*, struct vlx_descriptor*, void*, uint64_t, uint32_t, uint32_t, uint32_t);
+
+/* vlx_compute_dispatch_indirect 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		primary command structure 
+ * struct vlx_pipeline*		compute pipeline 
+ * struct vlx_descriptor*	descriptor structure, or 0 
+ * void*					push constant 
+ * uint64_t					size of push constants 
+ * struct vlx_buffer*		indirect or storage buffer holding the workgroup counts 
+ * uint64_t					offset of the workgroup counts 
+ * 
+ * Same as vlx_compute_dispatch, but reads the workgroup counts as 3 uint32_t values from a buffer, which an earlier dispatch may have 
+ * written. Returns 1 if the dispatch was recorded, 0 otherwise. 
+ **/
+
+int8_t vlx_compute_dispatch_indirect(struct vlx_context*, struct vlx_surface*, struct vlx_command*, struct vlx_pipeline*, struct vlx_descriptor*, void*, uint64_t, struct vlx_buffer*, uint64_t);
+
+/* vlx_compute_begin 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		compute command structure 
+ * 
+ * Begins recording async compute work for the current frame. Must be called after vlx_surface_new_frame, which waits for the frame slot 
+ * to be free for both queues. 
+ **/
+
+void vlx_compute_begin(struct vlx_context*, struct vlx_surface*, struct vlx_command*);
+
+/* vlx_compute_submit 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		compute command structure 
+ * 
+ * Submits the recorded async compute work to the compute queue, where it overlaps with the frame's graphics recording. Once a surface 
+ * has used async compute, each graphics submission signals a semaphore that the next compute submission waits on, so compute reads 
+ * what the previous frame rendered, such as the depth pyramid, only after it is written. The next vlx_surface_swap_frame makes the 
+ * graphics submission wait on the compute work before reading indirect commands, vertices or shader resources, so buffers written here 
+ * can be drawn from in the same frame. 
+ **/
+
+void vlx_compute_submit(struct vlx_context*, struct vlx_surface*, struct vlx_command*);
+
+/* vlx_cull_create 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_shader*		culling compute shader (vlx_cull.spv) 
+ * uint32_t					maximum number of objects 
+ * uint8_t					buffer mode of the objects, VLX_BUFFER_DYNAMIC or VLX_BUFFER_STATIC 
+ * 
+ * Creates a frustum culling pass. Static objects are uploaded once, dynamic objects can be rewritten by the application as long as 
+ * frames in flight are not reading them. The draw commands and count have one region per frame in flight, so a dispatch on the async 
+ * compute queue never overwrites commands an earlier frame is still drawing from. Occlusion culling is off until a hiz structure is 
+ * attached with vlx_cull_occlusion. The draw commands carry each object's first instance, so 0 is returned if the device lacks 
+ * drawIndirectFirstInstance, as well as when device memory cannot be allocated. 
+ **/
+
+struct vlx_cull* vlx_cull_create(struct vlx_context*, struct vlx_shader*, uint32_t, uint8_t);
+
+/* vlx_cull_refresh 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_cull*			cull structure 
+ * const struct vlx_cull_object*	objects 
+ * uint32_t					number of objects 
+ * uint32_t					index of the first object to write 
+ * 
+ * Writes a range of objects. 
+ **/
+
+void vlx_cull_refresh(struct vlx_context*, struct vlx_cull*, const struct vlx_cull_object*, uint32_t, uint32_t);
+
+/* vlx_cull_dispatch 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		primary command structure 
+ * struct vlx_cull*			cull structure 
+ * const float*				column major view projection matrix 
+ * uint32_t					number of objects to test 
+ * 
+ * Records the culling pass. The six frustum planes are taken from the matrix, with Vulkan's 0 to 1 depth range, and every object is 
+ * tested against them on the GPU. With VK_KHR_draw_indirect_count the visible objects are compacted into consecutive draw commands and 
+ * counted. Without it every object keeps its slot and hidden ones get an instance count of 0. Must be recorded before the first draw 
+ * of the frame, like vlx_compute_dispatch. With an attached hiz structure, objects inside the frustum are also projected to the 
+ * screen and rejected when their nearest depth lies behind the depth pyramid over their bounds. Returns 1 if the pass was recorded, 
+ * or 0 if it was not, in which case vlx_surface_draw_culled draws nothing this frame. 
+ **/
+
+int8_t vlx_cull_dispatch(struct vlx_context*, struct vlx_surface*, struct vlx_command*, struct vlx_cull*, const float*, uint32_t);
+
+/* vlx_hiz_create 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_shader*		depth pyramid compute shader (vlx_hiz.spv) 
+ * 
+ * Creates a depth pyramid for the surface depth buffer. When vlx_surface_resize or vlx_surface_present replaces the depth buffer, they 
+ * rebuild the pyramid for the new buffer while the device is idle, and cull structures using it are pointed at the new pyramid on 
+ * their next dispatch. Returns 0 if device memory cannot be allocated. 
+ **/
+
+struct vlx_hiz* vlx_hiz_create(struct vlx_context*, struct vlx_surface*, struct vlx_shader*);
+
+/* vlx_hiz_build 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		primary command structure 
+ * struct vlx_hiz*			hiz structure 
+ * 
+ * Records the downsampling of the depth left by the previous frame into the pyramid. Must be recorded before the first draw of the 
+ * frame and before a vlx_cull_dispatch on the same command structure. The first call only marks the depth buffer as written, since no 
+ * frame has rendered into it yet, and culling stays frustum only until the next build, which also applies after the depth buffer was 
+ * replaced. Objects that come into view from behind an occluder appear one frame late, or two when culling runs on the async compute 
+ * queue, which reads the pyramid built by the previous frame. Returns 1 if the build was recorded, or 0 if it was not because the 
+ * render pass has already begun, the command structure is not a graphics primary, or the pyramid rebuilt by the last resize could not 
+ * be allocated. 
+ **/
+
+int8_t vlx_hiz_build(struct vlx_context*, struct vlx_surface*, struct vlx_command*, struct vlx_hiz*);
+
+/* vlx_cull_occlusion 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_cull*			cull structure 
+ * struct vlx_hiz*			hiz structure, or 0 to turn occlusion culling off 
+ * 
+ * Attaches a depth pyramid to the culling pass. Must not be called while frames using the cull structure are in flight. 
+ **/
+
+void vlx_cull_occlusion(struct vlx_context*, struct vlx_cull*, struct vlx_hiz*);
+
+/* vlx_surface_draw_culled 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_pipeline*		Vulkan pipeline 
+ * struct vlx_command*		command structure 
+ * struct vlx_buffer*		index buffer 
+ * struct vlx_vertex*		vertex buffer 
+ * struct vlx_descriptor*	descriptor structure 
+ * void*					push constant
+ * uint64_t					size of push constanst 
+ * struct vlx_cull*			cull structure 
+ * 
+ * Draws the objects that passed the vlx_cull_dispatch of the current frame with vlx_surface_draw_indirect, without reading anything 
+ * back to the CPU. 
+ **/
+
+void vlx_surface_draw_culled(struct vlx_context*, struct vlx_surface*, struct vlx_pipeline*, struct vlx_command*, struct vlx_buffer*, struct vlx_vertex*, struct vlx_descriptor*, void*, uint64_t, struct vlx_cull*);
+
+/* vlx_command_stats 
+ * 
+ * struct vlx_command*		command structure 
+ * uint64_t*				number of state commands emitted 
+ * uint64_t*				number of state commands skipped as redundant 
+ * 
+ * Reports the state filtering counters of the command structure for the frame being recorded. Counters are reset by 
+ * vlx_surface_new_frame for primary and by vlx_command_begin for secondary command structures. 
+ **/
+
+void vlx_command_stats(struct vlx_command*, uint64_t*, uint64_t*);
+
+/* vlx_profile_create 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * uint32_t					maximum number of named scopes 
+ * 
+ * Creates a profile and attaches it to the surface. From then on vlx_surface_new_frame and vlx_surface_swap_frame time the CPU side of 
+ * every frame and bracket the primary command buffer with GPU timestamps. Timestamps are read back when the frame slot comes around 
+ * again, after its fence has been waited on, so profiling never stalls. GPU metrics stay empty when the graphics queue has no 
+ * timestamp support. 
+ **/
+
+struct vlx_profile* vlx_profile_create(struct vlx_context*, struct vlx_surface*, uint32_t);
+
+/* vlx_profile_scope 
+ * 
+ * struct vlx_profile*		profile structure 
+ * const char*				scope name 
+ * 
+ * Returns the index of the scope with that name, registering it on first use, or -1 when all scopes are taken. Its statistics are 
+ * under metric VLX_PROFILE_SCOPE plus the index. 
+ **/
+
+int32_t vlx_profile_scope(struct vlx_profile*, const char*);
+
+/* vlx_profile_begin 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		primary command structure 
+ * int32_t					scope index 
+ * 
+ * Writes the starting GPU timestamp of a scope. Each scope can be timed once per frame, and secondary and compute command structures 
+ * are ignored. 
+ **/
+
+void vlx_profile_begin(struct vlx_context*, struct vlx_surface*, struct vlx_command*, int32_t);
+
+/* vlx_profile_end 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		primary command structure 
+ * int32_t					scope index 
+ * 
+ * Writes the ending GPU timestamp of a scope opened with vlx_profile_begin in the same frame. 
+ **/
+
+void vlx_profile_end(struct vlx_context*, struct vlx_surface*, struct vlx_command*, int32_t);
+
+/* vlx_profile_stats 
+ * 
+ * struct vlx_profile*		profile structure 
+ * uint32_t					metric, one of VLX_PROFILE_ or VLX_PROFILE_SCOPE plus a scope index 
+ * struct vlx_profile_stats*	statistics to fill 
+ * 
+ * Computes rolling statistics over the last 256 samples of a metric. GPU samples lag the CPU ones by the number of frames in flight. 
+ * Comparing VLX_PROFILE_GPU with VLX_PROFILE_RECORD and VLX_PROFILE_WAIT tells whether slow frames are CPU or GPU bound. 
+ **/
+
+void vlx_profile_stats(struct vlx_profile*, uint32_t, struct vlx_profile_stats*);
+
+/* vlx_query_create 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * uint8_t					query type, one of VLX_QUERY_ 
+ * uint32_t					number of slots per frame 
+ * 
+ * Creates a query ring and attaches it to the surface. vlx_surface_new_frame collects the results the frame slot produced the last time 
+ * around, after its fence has been waited on, and resets the slots, so results are never waited for. Returns 0 for VLX_QUERY_STATISTICS 
+ * when the device lacks pipeline statistics queries. 
+ **/
+
+struct vlx_query* vlx_query_create(struct vlx_context*, struct vlx_surface*, uint8_t, uint32_t);
+
+/* vlx_query_begin 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		primary command structure 
+ * struct vlx_query*		query structure 
+ * 
+ * Begins the next free slot of the frame around the draws that follow and returns its index, or -1 when all slots of the frame are 
+ * taken. Starts the frame's render pass, so compute dispatches must be recorded before it. Secondary and compute command structures, and 
+ * frames begun for secondary command buffers, are ignored. 
+ **/
+
+int32_t vlx_query_begin(struct vlx_context*, struct vlx_surface*, struct vlx_command*, struct vlx_query*);
+
+/* vlx_query_end 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * struct vlx_command*		primary command structure 
+ * struct vlx_query*		query structure 
+ * int32_t					slot index returned by vlx_query_begin 
+ * 
+ * Ends a slot begun in the same frame. Slots of the same query structure must not overlap. 
+ **/
+
+void vlx_query_end(struct vlx_context*, struct vlx_surface*, struct vlx_command*, struct vlx_query*, int32_t);
+
+/* vlx_query_result 
+ * 
+ * struct vlx_query*		query structure 
+ * uint32_t					slot index 
+ * uint64_t*				1 value for occlusion or VLX_QUERY_STATISTICS_N values for statistics 
+ * 
+ * Copies the result of a slot from the frame collected by the last vlx_surface_new_frame, as many frames back as there are frames in 
+ * flight, and returns 1, or returns 0 when that frame did not use the slot. An occlusion result of 0 for a bounding box proxy means the 
+ * object can be skipped until a later proxy draw reports it visible again. 
+ **/
+
+int8_t vlx_query_result(struct vlx_query*, uint32_t, uint64_t*);
+
 /* vlx_surface_swap_frame 
  * 
  * struct vlx_context*		Vulkan context 
@@ -364,10 +1465,49 @@ void vlx_surface_swap_frame(struct vlx_context*, struct vlx_surface*, struct vlx
  * uint32_t					width 
  * uint32_t					height 
  * 
- * Resizes surface. 
+ * Resizes surface. Returns 0 if device memory for the new images or depth buffer cannot be allocated, after which the surface can 
+ * only be resized again or destroyed. 
+ **/
+
+int8_t vlx_surface_resize(struct vlx_context*, struct vlx_surface*, uint32_t, uint32_t);
+
+/* vlx_surface_read 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		offscreen surface 
+ * void*					pixels, width * height * 4 bytes 
+ * 
+ * Copies the last frame swapped on an offscreen surface into pixels, tightly packed rows of 8 bit BGRA in the color scheme chosen at 
+ * vlx_context_create, waiting for the frame to finish on the GPU. Should be called between vlx_surface_swap_frame and the next 
+ * vlx_surface_new_frame. Frames are copied into host cached memory where the device has it, so reading them back is not slowed by 
+ * uncached reads. Returns 0 for window surfaces or before the first frame. 
+ **/
+
+int8_t vlx_surface_read(struct vlx_context*, struct vlx_surface*, void*);
+
+/* vlx_surface_present 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_surface*		Vulkan surface 
+ * uint8_t					present mode, one of VLX_PRESENT_ 
+ * 
+ * Sets the present mode of a surface and returns the mode in use. When the mode is not supported, mailbox and immediate fall back to 
+ * each other, then to relaxed fifo, then to fifo, which is always supported. Called before vlx_surface_init_swapchain it only records 
+ * the mode. Afterwards it waits for the device to be idle and recreates the swapchain and frame buffers if the mode in use changes, so 
+ * it should not be called every frame. Returns UINT8_MAX if the depth buffer has to be recreated and its memory cannot be allocated, 
+ * after which the surface can only be resized or destroyed. 
+ **/
+
+uint8_t vlx_surface_present(struct vlx_context*, struct vlx_surface*, uint8_t);
+
+/* vlx_surface_present_mode 
+ * 
+ * struct vlx_surface*		Vulkan surface 
+ * 
+ * Returns the present mode in use by the surface's swapchain, one of VLX_PRESENT_. 
  **/
 
-void vlx_surface_resize(struct vlx_context*, struct vlx_surface*, uint32_t, uint32_t);
+uint8_t vlx_surface_present_mode(struct vlx_surface*);
 
 /* vlx_buffer_destroy 
  * 
@@ -419,12 +1559,22 @@ void vlx_texture_destroy(struct vlx_context*, struct vlx_texture*);
 
 void vlx_descriptor_destroy(struct vlx_context*, struct vlx_descriptor*);
 
+/* vlx_shader_destroy 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_shader*		shader 
+ * 
+ * Releases a reference to the shader and frees it when none are left. 
+ **/
+
+void vlx_shader_destroy(struct vlx_context*, struct vlx_shader*);
+
 /* vlx_pipeline_destroy 
  * 
  * struct vlx_context*		Vulkan context 
  * struct vlx_pipeline*		Vulkan pipeline
  * 
- * Frees pipeline resources. 
+ * Releases a reference to the pipeline and frees it when none are left. 
  **/
 
 void vlx_pipeline_destroy(struct vlx_context*, struct vlx_pipeline*);
@@ -439,6 +1589,47 @@ void vlx_pipeline_destroy(struct vlx_context*, struct vlx_pipeline*);
 
 void vlx_command_destroy(struct vlx_context*, struct vlx_command*);
 
+/* vlx_cull_destroy 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_cull*			cull structure 
+ * 
+ * Frees culling resources. 
+ **/
+
+void vlx_cull_destroy(struct vlx_context*, struct vlx_cull*);
+
+/* vlx_hiz_destroy 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_hiz*			hiz structure 
+ * 
+ * Detaches the depth pyramid from its surface and frees its resources. Cull structures using it must be detached or destroyed first, 
+ * and it must be destroyed before the surface. 
+ **/
+
+void vlx_hiz_destroy(struct vlx_context*, struct vlx_hiz*);
+
+/* vlx_profile_destroy 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_profile*		profile structure 
+ * 
+ * Detaches the profile from its surface and frees its resources. Must be called before the surface is destroyed. 
+ **/
+
+void vlx_profile_destroy(struct vlx_context*, struct vlx_profile*);
+
+/* vlx_query_destroy 
+ * 
+ * struct vlx_context*		Vulkan context 
+ * struct vlx_query*		query structure 
+ * 
+ * Detaches the query ring from its surface and frees its resources. Must be called before the surface is destroyed. 
+ **/
+
+void vlx_query_destroy(struct vlx_context*, struct vlx_query*);
+
 /* vlx_surface_destroy 
  * 
  * struct vlx_context*		Vulkan context 
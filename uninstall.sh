@@ -2,3 +2,4 @@
 
 rm /usr/lib/libvlx.so
 rm -rf /usr/include/vlx
+rm -rf /usr/share/vlx